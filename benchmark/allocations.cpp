@@ -0,0 +1,76 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+// Replacement of the global `operator new` and `operator delete` counting the
+// allocations made by a benchmark, which `perf_region` reports for the code
+// executed during its lifetime (see `perf.hpp`). Every benchmark is linked
+// with this file.
+
+#include "perf.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+
+namespace {
+  std::atomic<unsigned long long> allocation_count{0};
+  std::atomic<unsigned long long> allocated_bytes{0};
+
+  void count(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  }
+
+  void* allocate(std::size_t size) {
+    count(size);
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+      return p;
+    throw std::bad_alloc{};
+  }
+
+  void* allocate(std::size_t size, std::align_val_t alignment) {
+    std::size_t align = static_cast<std::size_t>(alignment);
+    count(size);
+    // aligned_alloc requires the size to be a non-zero multiple of the
+    // alignment.
+    std::size_t rounded = (size == 0 ? 1 : size) + align - 1;
+    if (rounded < align)
+      throw std::bad_alloc{};
+    rounded -= rounded % align;
+    if (void* p = std::aligned_alloc(align, rounded))
+      return p;
+    throw std::bad_alloc{};
+  }
+}
+
+namespace metabench {
+  allocation_totals_t allocation_totals() {
+    return {allocation_count.load(std::memory_order_relaxed),
+            allocated_bytes.load(std::memory_order_relaxed)};
+  }
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t a) { return allocate(size, a); }
+void* operator new[](std::size_t size, std::align_val_t a) { return allocate(size, a); }
+
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept {
+  try { return allocate(size); } catch (std::bad_alloc const&) { return nullptr; }
+}
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept {
+  try { return allocate(size); } catch (std::bad_alloc const&) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::nothrow_t const&) noexcept { std::free(p); }
+void operator delete[](void* p, std::nothrow_t const&) noexcept { std::free(p); }
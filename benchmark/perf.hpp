@@ -0,0 +1,139 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#ifndef BENCHMARK_PERF_HPP
+#define BENCHMARK_PERF_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#if defined(__linux__)
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+
+// `perf_region` measures the code executed during its lifetime with the
+// hardware performance counters, and reports the results on stdout as
+// `[perf <counter>: <value>]` lines which `metabench.rb` collects alongside
+// the other measurements. This makes it possible to time only the `loop()`
+// of a benchmark instead of the whole process, and to chart aspects like
+// `CYCLES_PER_ITERATION` or `BRANCH_MISSES`.
+//
+// The counters are read through Linux's `perf_event_open`. When that is not
+// available (other platforms, or a restrictive `perf_event_paranoid`), only
+// the wall-clock time of the region is reported.
+//
+// The number of heap allocations made in the region, and the number of bytes
+// they requested, are reported as `allocations` and `bytes_allocated`. They
+// are counted by the global `operator new` of `allocations.cpp`, which the
+// benchmarks are linked with, and include the allocations of all threads.
+namespace metabench {
+  struct allocation_totals_t { unsigned long long count, bytes; };
+
+  // Totals since the start of the program, defined by `allocations.cpp`. The
+  // declaration is weak so that this header can be used without it, in which
+  // case allocations are not reported.
+  allocation_totals_t allocation_totals() __attribute__((weak));
+
+#if defined(__linux__)
+  namespace detail {
+    struct perf_counter { char const* name; std::uint32_t type; std::uint64_t config; };
+
+    constexpr std::uint64_t cache_miss(std::uint64_t cache) {
+      return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                   | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+
+    constexpr perf_counter perf_counters[] = {
+      {"cycles",        PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {"instructions",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+      {"l1d_misses",    PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D)},
+      {"llc_misses",    PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL)}
+    };
+  }
+#endif
+
+  class perf_region {
+#if defined(__linux__)
+    static constexpr std::size_t N = sizeof(detail::perf_counters) / sizeof(detail::perf_counters[0]);
+    int fds_[N];
+
+    static int open(detail::perf_counter const& c) {
+      perf_event_attr attr{};
+      attr.size = sizeof(attr);
+      attr.type = c.type;
+      attr.config = c.config;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+
+    unsigned long long iterations_;
+    allocation_totals_t allocations_{0, 0};
+    std::chrono::steady_clock::time_point start_;
+
+  public:
+    explicit perf_region(unsigned long long iterations) : iterations_(iterations) {
+#if defined(__linux__)
+      for (std::size_t i = 0; i != N; ++i)
+        fds_[i] = open(detail::perf_counters[i]);
+      for (int fd : fds_)
+        if (fd != -1) ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      for (int fd : fds_)
+        if (fd != -1) ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+      if (allocation_totals)
+        allocations_ = allocation_totals();
+      start_ = std::chrono::steady_clock::now();
+    }
+
+    perf_region(perf_region const&) = delete;
+    perf_region& operator=(perf_region const&) = delete;
+
+    ~perf_region() {
+      auto stop = std::chrono::steady_clock::now();
+#if defined(__linux__)
+      for (int fd : fds_)
+        if (fd != -1) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+      allocation_totals_t allocations = allocations_;
+      if (allocation_totals)
+        allocations = allocation_totals();
+
+      std::chrono::duration<double> elapsed = stop - start_;
+      std::printf("[perf region_time: %.9f]\n", elapsed.count());
+      if (iterations_ != 0 && elapsed.count() > 0)
+        std::printf("[perf throughput: %.0f]\n", iterations_ / elapsed.count());
+      if (allocation_totals) {
+        std::printf("[perf allocations: %llu]\n", allocations.count - allocations_.count);
+        std::printf("[perf bytes_allocated: %llu]\n", allocations.bytes - allocations_.bytes);
+      }
+
+#if defined(__linux__)
+      for (std::size_t i = 0; i != N; ++i) {
+        std::uint64_t value;
+        if (fds_[i] == -1)
+          continue;
+        if (read(fds_[i], &value, sizeof(value)) == sizeof(value)) {
+          std::printf("[perf %s: %llu]\n", detail::perf_counters[i].name,
+                                           static_cast<unsigned long long>(value));
+          if (i == 0 && iterations_ != 0)
+            std::printf("[perf cycles_per_iteration: %.3f]\n",
+                        static_cast<double>(value) / iterations_);
+        }
+        close(fds_[i]);
+      }
+#endif
+    }
+  };
+} // end namespace metabench
+
+#endif
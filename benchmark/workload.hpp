@@ -0,0 +1,163 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#ifndef BENCHMARK_WORKLOAD_HPP
+#define BENCHMARK_WORKLOAD_HPP
+
+#include "../code/callbacks.log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+// Helpers for benchmarks that drive an event system with something closer to
+// a production workload than a fixed, perfectly predictable sequence of
+// events: randomized or recorded event sequences, handlers that touch memory,
+// and a per-trigger latency distribution.
+//
+// Like `perf_region`, the results are reported on stdout as `[perf <name>:
+// <value>]` lines, so they can be charted with `ASPECT LATENCY_P99` and the
+// like.
+namespace metabench {
+  // Sequence of `count` events drawn uniformly from `[0, events)`.
+  inline std::vector<std::uint32_t>
+  uniform_sequence(std::uint32_t events, std::size_t count, std::uint64_t seed = 42) {
+    std::mt19937_64 rng{seed};
+    std::uniform_int_distribution<std::uint32_t> dist{0, events - 1};
+    std::vector<std::uint32_t> sequence(count);
+    for (auto& e : sequence)
+      e = dist(rng);
+    return sequence;
+  }
+
+  // Sequence of `count` events drawn from a Zipf distribution with exponent
+  // `skew` over `[0, events)`. The popularity ranks are shuffled so the
+  // hottest events are not simply the first few ones.
+  inline std::vector<std::uint32_t>
+  zipf_sequence(std::uint32_t events, std::size_t count, double skew = 1.0, std::uint64_t seed = 42) {
+    std::mt19937_64 rng{seed};
+    std::vector<double> cdf(events);
+    double sum = 0;
+    for (std::uint32_t k = 0; k != events; ++k)
+      cdf[k] = sum += 1.0 / std::pow(k + 1, skew);
+
+    std::vector<std::uint32_t> rank(events);
+    std::iota(rank.begin(), rank.end(), 0);
+    std::shuffle(rank.begin(), rank.end(), rng);
+
+    std::uniform_real_distribution<double> dist{0, sum};
+    std::vector<std::uint32_t> sequence(count);
+    for (auto& e : sequence) {
+      auto k = std::lower_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin();
+      e = rank[std::min<std::size_t>(k, events - 1)];
+    }
+    return sequence;
+  }
+
+  // Sequence of events read from a recorded trace, which is either a log
+  // written by `event_log` or a text file of whitespace-separated event
+  // indices. Indices are wrapped into `[0, events)` so a single trace can be
+  // replayed against any number of events.
+  inline std::vector<std::uint32_t>
+  trace_sequence(std::string const& path, std::uint32_t events) {
+    if (is_event_log(path)) {
+      std::vector<std::uint32_t> sequence;
+      event_log_reader{path}.for_each([&](event_record const& record) {
+        sequence.push_back(record.event % events);
+      });
+      return sequence;
+    }
+
+    std::ifstream in{path};
+    if (!in)
+      throw std::runtime_error{"unable to open the event trace " + path};
+    std::vector<std::uint32_t> sequence;
+    for (std::uint64_t e; in >> e; )
+      sequence.push_back(static_cast<std::uint32_t>(e % events));
+    return sequence;
+  }
+
+  // Memory touched by the event handlers. Each call to `touch(e)` updates one
+  // cache line picked pseudo-randomly from the handler's index and from the
+  // number of calls so far, so handlers keep evicting each other's data when
+  // the working set is larger than the cache.
+  class working_set {
+    std::vector<std::uint64_t> memory_;
+    std::uint64_t calls_ = 0;
+
+  public:
+    explicit working_set(std::size_t bytes)
+      : memory_(std::max<std::size_t>(bytes / sizeof(std::uint64_t), 8))
+    { }
+
+    void touch(std::uint32_t e) {
+      std::uint64_t h = (e + 1) * 0x9E3779B97F4A7C15ull + calls_++;
+      std::size_t line = (h ^ (h >> 29)) % (memory_.size() / 8);
+      memory_[line * 8] += e;
+    }
+
+    std::uint64_t checksum() const {
+      return std::accumulate(memory_.begin(), memory_.end(), std::uint64_t{0});
+    }
+  };
+
+  // Records the latency of individual operations and reports the p50, p99
+  // and p99.9 in nanoseconds. The median cost of reading the clock twice is
+  // measured once and subtracted from every sample, since it is of the same
+  // order as the operations being measured.
+  class latency_recorder {
+    using clock = std::chrono::steady_clock;
+    std::vector<std::uint32_t> samples_;
+    std::int64_t overhead_;
+
+    static std::int64_t clock_overhead() {
+      std::vector<std::int64_t> samples(1000);
+      for (auto& s : samples) {
+        auto start = clock::now();
+        s = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+      }
+      std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+      return samples[samples.size() / 2];
+    }
+
+    double percentile(double p) {
+      std::size_t i = std::min(samples_.size() - 1,
+                               static_cast<std::size_t>(p * samples_.size()));
+      std::nth_element(samples_.begin(), samples_.begin() + i, samples_.end());
+      return samples_[i];
+    }
+
+  public:
+    explicit latency_recorder(std::size_t expected) : overhead_(clock_overhead()) {
+      samples_.reserve(expected);
+    }
+
+    template <typename F>
+    void measure(F&& f) {
+      auto start = clock::now();
+      f();
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+      samples_.push_back(static_cast<std::uint32_t>(std::max<std::int64_t>(0, ns.count() - overhead_)));
+    }
+
+    ~latency_recorder() {
+      if (samples_.empty())
+        return;
+      std::printf("[perf latency_p50: %.0f]\n", percentile(0.5));
+      std::printf("[perf latency_p99: %.0f]\n", percentile(0.99));
+      std::printf("[perf latency_p999: %.0f]\n", percentile(0.999));
+    }
+  };
+} // end namespace metabench
+
+#endif
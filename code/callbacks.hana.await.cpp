@@ -0,0 +1,119 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#include "callbacks.hana.await.hpp"
+
+#include <cassert>
+#include <string>
+#include <vector>
+namespace hana = boost::hana;
+using namespace hana::literals;
+
+
+#if defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+#include <exception>
+
+// sample(usage)
+template <typename Events>
+detached_task log_connections(Events& events, std::vector<std::string>& log) {
+  while (true) {
+    co_await events.next("connect"_s);
+    log.push_back("connected");
+    co_await events.next("disconnect"_s);
+    log.push_back("disconnected");
+  }
+}
+// end-sample
+
+template <typename Events>
+detached_task wait_once(Events& events, int& resumed) {
+  co_await events.next("connect"_s);
+  ++resumed;
+}
+
+// A coroutine that can be destroyed while it is suspended.
+struct owned_task {
+  struct promise_type {
+    owned_task get_return_object() noexcept {
+      return {std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() noexcept { }
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+  std::coroutine_handle<promise_type> handle;
+};
+
+template <typename Events>
+owned_task wait_owned(Events& events, int& resumed) {
+  co_await events.next("connect"_s);
+  ++resumed;
+}
+
+int main() {
+  auto events = make_awaitable_event_system("connect"_s, "disconnect"_s);
+  std::vector<std::string> log;
+  int callbacks = 0;
+  events.on("connect"_s, [&]{ ++callbacks; });
+
+  log_connections(events, log);
+  assert(log.empty());
+
+  events.trigger("disconnect"_s); // nobody is waiting for that yet
+  assert(log.empty());
+
+  events.trigger("connect"_s);
+  assert((log == std::vector<std::string>{"connected"}));
+  assert(callbacks == 1);
+
+  events.trigger("connect"_s); // already waiting for "disconnect"
+  assert(log.size() == 1);
+
+  events.trigger("disconnect"_s);
+  assert((log == std::vector<std::string>{"connected", "disconnected"}));
+
+  // Every waiter is resumed exactly once, and those that complete destroy
+  // themselves without disturbing the others.
+  int resumed = 0;
+  for (int i = 0; i != 1000; ++i)
+    wait_once(events, resumed);
+  events.trigger("connect"_s);
+  assert(resumed == 1000);
+  assert(log.size() == 3);
+  events.trigger("connect"_s);
+  assert(resumed == 1000);
+  assert(callbacks == 4);
+
+  // Triggering an event by its name resumes its waiters too.
+  events.trigger(std::string{"connect"});
+  assert(log.size() == 3);
+  events.trigger(std::string{"disconnect"});
+  assert(log.size() == 4);
+  events.trigger_all("connect"_s, "disconnect"_s);
+  assert(log.size() == 6);
+  events.trigger_batch(std::vector<std::string>{"connect"});
+  assert(log.size() == 7);
+
+  // A coroutine destroyed while it waits is not resumed.
+  int owned = 0;
+  owned_task first = wait_owned(events, owned);
+  owned_task second = wait_owned(events, owned);
+  first.handle.destroy();
+  events.trigger("connect"_s);
+  assert(owned == 1 && second.handle.done());
+  second.handle.destroy();
+
+  // Moving the event system moves the waiters along.
+  auto moved = std::move(events);
+  moved.trigger("disconnect"_s);
+  assert(log.size() == 8);
+}
+
+#else
+
+int main() { }
+
+#endif
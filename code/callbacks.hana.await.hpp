@@ -0,0 +1,217 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#ifndef CODE_CALLBACKS_HANA_AWAIT_HPP
+#define CODE_CALLBACKS_HANA_AWAIT_HPP
+
+#include "callbacks.hana.hpp"
+
+#if defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <utility>
+namespace hana = boost::hana;
+
+
+// This is the same thing as `callbacks.hana.hpp`, except one can also wait
+// for the next occurrence of an event with `co_await events.next(event)`.
+//
+// Instead of registering a one-shot callback, the awaiter itself is linked
+// into an intrusive list of waiters for that event. Since the awaiter lives
+// in the frame of the suspended coroutine, waiting for an event does not
+// allocate anything, and triggering the event resumes each waiter in the
+// order in which it started waiting. A coroutine destroyed while it waits
+// unlinks its awaiter, and the waiters still linked when the event system is
+// destroyed are never resumed.
+//
+// Since the lists point into coroutine frames and the frames point back into
+// the lists, an awaitable event system can be moved, which moves its waiters
+// along, but not copied.
+
+namespace detail {
+  struct waiter_list;
+
+  struct waiter {
+    std::coroutine_handle<> handle;
+    waiter_list* list = nullptr;
+    waiter* prev = nullptr;
+    waiter* next = nullptr;
+  };
+
+  struct waiter_list {
+    waiter* head = nullptr;
+    waiter* tail = nullptr;
+
+    waiter_list() = default;
+    waiter_list(waiter_list const&) = delete;
+    waiter_list& operator=(waiter_list const&) = delete;
+    waiter_list(waiter_list&& other) noexcept { take(other); }
+    waiter_list& operator=(waiter_list&& other) noexcept {
+      if (this != &other) {
+        clear();
+        take(other);
+      }
+      return *this;
+    }
+    ~waiter_list() { clear(); }
+
+    void push(waiter* w) {
+      w->list = this;
+      w->prev = tail;
+      w->next = nullptr;
+      if (tail) tail->next = w;
+      else      head = w;
+      tail = w;
+    }
+
+    void unlink(waiter* w) {
+      if (w->prev) w->prev->next = w->next;
+      else         head = w->next;
+      if (w->next) w->next->prev = w->prev;
+      else         tail = w->prev;
+      w->list = nullptr;
+      w->prev = w->next = nullptr;
+    }
+
+    // Waiters that start waiting while the list is being resumed are only
+    // resumed by the next trigger. The waiters being resumed are moved to a
+    // list of their own first, so a waiter destroyed by the resumption of
+    // another one still unlinks itself from the right list.
+    void resume_all() {
+      waiter_list resuming{std::move(*this)};
+      while (waiter* w = resuming.head) {
+        resuming.unlink(w);
+        w->handle.resume();
+      }
+    }
+
+  private:
+    void take(waiter_list& other) {
+      head = other.head;
+      tail = other.tail;
+      other.head = other.tail = nullptr;
+      for (waiter* w = head; w; w = w->next)
+        w->list = this;
+    }
+
+    void clear() {
+      while (head)
+        unlink(head);
+    }
+  };
+
+  struct next_awaiter : waiter {
+    waiter_list* target;
+    explicit next_awaiter(waiter_list* l) : target(l) { }
+    next_awaiter(next_awaiter const&) = delete;
+    next_awaiter& operator=(next_awaiter const&) = delete;
+    ~next_awaiter() {
+      if (list)
+        list->unlink(this);
+    }
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) noexcept {
+      handle = h;
+      target->push(this);
+    }
+    void await_resume() const noexcept { }
+  };
+}
+
+// sample(struct)
+template <typename ...Events>
+struct awaitable_event_system : event_system<Events...> {
+  mutable hana::map<hana::pair<Events, detail::waiter_list>...> waiters_;
+// end-sample
+
+awaitable_event_system() = default;
+awaitable_event_system(awaitable_event_system const&) = delete;
+awaitable_event_system& operator=(awaitable_event_system const&) = delete;
+awaitable_event_system(awaitable_event_system&&) = default;
+awaitable_event_system& operator=(awaitable_event_system&&) = default;
+
+// sample(next)
+template <typename Event>
+detail::next_awaiter next(Event e) {
+  auto is_known_event = hana::contains(waiters_, e);
+  static_assert(is_known_event,
+    "trying to wait for an unknown event");
+
+  return detail::next_awaiter{&waiters_[e]};
+}
+// end-sample
+
+using event_system<Events...>::trigger;
+
+// sample(trigger)
+template <typename Event>
+void trigger(Event e) const {
+  event_system<Events...>::trigger(e);
+  waiters_[e].resume_all();
+}
+// end-sample
+
+void trigger(std::string_view e) const {
+  trigger_slot(this->slot_of(e));
+}
+
+void trigger_slot(std::size_t i) const {
+  for (auto& callback : this->index_[i].callbacks(*this))
+    callback();
+  hana::for_each(hana::keys(waiters_), [&](auto event) {
+    if (detail::key_hash(event) == this->index_[i].hash)
+      waiters_[event].resume_all();
+  });
+}
+
+void trigger(std::string const& e) const {
+  trigger(std::string_view{e});
+}
+
+// The batched triggers of `event_system` would not resume the waiters, so
+// they are replaced by the equivalent sequences of calls to `trigger`.
+template <typename ...Event>
+void trigger_all(Event ...e) const {
+  (trigger(e), ...);
+}
+
+template <typename Event>
+void trigger_n(Event e, std::size_t count) const {
+  for (; count != 0; --count)
+    trigger(e);
+}
+
+template <typename Names>
+void trigger_batch(Names const& names) const {
+  this->group_by_event(names, [this](std::size_t i, std::size_t n) {
+    for (; n != 0; --n)
+      trigger_slot(i);
+  });
+}
+};
+
+template <typename ...Events>
+awaitable_event_system<Events...> make_awaitable_event_system(Events ...events) {
+  return {};
+}
+
+// A coroutine that starts right away and destroys itself when it completes,
+// which is all that is needed to run waiters on a single-threaded executor.
+struct detached_task {
+  struct promise_type {
+    detached_task get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept { }
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+#endif // __cpp_impl_coroutine
+
+#endif
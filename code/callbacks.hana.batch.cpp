@@ -0,0 +1,45 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#include "callbacks.hana.hpp"
+
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+namespace hana = boost::hana;
+using namespace hana::literals;
+
+
+int main() {
+  auto events = make_event_system("begin"_s, "data"_s, "end"_s);
+
+  std::string log;
+  events.on("begin"_s, [&] { log += '['; });
+  events.on("data"_s, [&] { log += 'd'; });
+  events.on("data"_s, [&] { log += 'D'; });
+  events.on("end"_s, [&] { log += ']'; });
+
+  // sample(usage)
+  events.trigger_all("begin"_s, "data"_s, "end"_s);
+  events.trigger_n("data"_s, 3);
+
+  std::vector<std::string_view> batch = {"data", "begin", "data", "end"};
+  events.trigger_batch(batch);
+  // end-sample
+
+  // trigger_all and trigger_n keep the order of the events and callbacks, and
+  // trigger_batch groups the events by name, in the order they first appear.
+  assert(log == "[dD]" "dDdDdD" "dDdD" "[" "]");
+
+  // A batch naming an unknown event triggers nothing.
+  log.clear();
+  bool thrown = false;
+  try {
+    events.trigger_batch(std::vector<std::string_view>{"begin", "nope"});
+  } catch (std::out_of_range const&) {
+    thrown = true;
+  }
+  assert(thrown && log.empty());
+}
@@ -0,0 +1,67 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#include "callbacks.hana.coalesce.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <vector>
+namespace hana = boost::hana;
+using namespace std::literals;
+
+
+int main() {
+// sample(usage)
+  auto events = make_coalescing_event_system(
+    "price"_e = coalesced(function<void(std::string, double)>),
+    "config"_e = coalesced(function<void()>),
+    "trade"_e = function<void(double)>
+  );
+// end-sample
+
+  std::vector<std::pair<std::string, double>> prices;
+  int configs = 0;
+  std::vector<double> trades;
+  events.on("price"_e, [&](std::string s, double p) { prices.push_back({s, p}); });
+  events.on("config"_e, [&] { ++configs; });
+  events.on("trade"_e, [&](double t) { trades.push_back(t); });
+
+  // A burst of triggers only records the latest arguments.
+  for (int i = 0; i != 10000; ++i) {
+    events.trigger("price"_e, "ACME"s, 100.0 + i);
+    events.trigger("config"_e);
+  }
+  assert(prices.empty());
+  assert(configs == 0);
+
+  // Events that are not coalesced still run their handlers right away.
+  events.trigger("trade"_e, 1.5);
+  assert((trades == std::vector<double>{1.5}));
+
+  // Each coalesced event runs its handlers once per flush.
+  events.flush();
+  assert(prices.size() == 1);
+  assert(prices[0].first == "ACME" && prices[0].second == 100.0 + 9999);
+  assert(configs == 1);
+
+  // Nothing happens when nothing was triggered since the last flush.
+  events.flush();
+  assert(prices.size() == 1);
+  assert(configs == 1);
+
+  events.trigger("config"_e);
+  events.flush();
+  assert(prices.size() == 1);
+  assert(configs == 2);
+
+  // `pump` only flushes once per time window.
+  events.trigger("config"_e);
+  assert(events.pump(0ms));
+  assert(configs == 3);
+  events.trigger("config"_e);
+  assert(!events.pump(1h));
+  assert(configs == 3);
+  events.flush();
+  assert(configs == 4);
+}
@@ -0,0 +1,145 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#ifndef CODE_CALLBACKS_HANA_COALESCE_HPP
+#define CODE_CALLBACKS_HANA_COALESCE_HPP
+
+#include "callbacks.hana.hetero.hpp"
+
+#include <boost/hana.hpp>
+
+#include <bitset>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+namespace hana = boost::hana;
+
+
+// The event system of `callbacks.hana.hetero.hpp`, where some events can be
+// coalesced. Triggering a coalesced event only records its arguments, and its
+// handlers are called once with the latest arguments by the next `flush()`,
+// no matter how many times it was triggered since. Other events still run
+// their handlers right away.
+
+// sample(coalesced)
+// Declares a coalesced event:
+//
+//  "price"_e = coalesced(function<void(double)>)
+template <typename Signature>
+struct coalesce;
+
+template <typename Signature>
+constexpr hana::basic_type<coalesce<Signature>> coalesced(hana::basic_type<Signature>) {
+  return {};
+}
+// end-sample
+
+namespace detail {
+  struct no_payload { };
+
+  template <typename Signature>
+  struct event_traits {
+    using signature = Signature;
+    using payload = no_payload;
+    static constexpr bool coalesced = false;
+  };
+
+  template <typename R, typename ...Args>
+  struct event_traits<coalesce<R(Args...)>> {
+    using signature = R(Args...);
+    using payload = std::optional<std::tuple<std::decay_t<Args>...>>;
+    static constexpr bool coalesced = true;
+  };
+}
+
+template <typename ...Events>
+struct coalescing_event_system;
+
+template <typename ...Events, typename ...Signatures>
+struct coalescing_event_system<hana::pair<Events, hana::basic_type<Signatures>>...>
+  : event_system<hana::pair<Events, hana::basic_type<
+      typename detail::event_traits<Signatures>::signature
+    >>...>
+{
+  using base = event_system<hana::pair<Events, hana::basic_type<
+    typename detail::event_traits<Signatures>::signature
+  >>...>;
+
+  // Latest arguments of each coalesced event, and which of them were
+  // triggered since the last flush.
+  mutable hana::map<
+    hana::pair<Events, typename detail::event_traits<Signatures>::payload>...
+  > pending_;
+  mutable std::bitset<sizeof...(Events)> dirty_;
+  std::chrono::steady_clock::time_point last_flush_ = std::chrono::steady_clock::now();
+
+  template <typename Event>
+  static constexpr bool is_coalesced(Event e) {
+    constexpr bool coalesced[] = {detail::event_traits<Signatures>::coalesced...};
+    return coalesced[base::index_of(e)];
+  }
+
+  // sample(trigger)
+  template <typename Event, typename ...Args>
+  void trigger(Event e, Args ...a) const {
+    auto is_known_event = hana::contains(this->map_, e);
+    static_assert(is_known_event,
+      "trying to trigger an unknown event");
+
+    if constexpr (is_coalesced(Event{})) {
+      pending_[e].emplace(std::move(a)...);
+      dirty_.set(base::index_of(e));
+    } else {
+      base::trigger(e, a...);
+    }
+  }
+  // end-sample
+
+  // sample(flush)
+  // Calls the handlers of every coalesced event triggered since the last
+  // flush, once, with the latest arguments it was triggered with.
+  void flush() {
+    if (dirty_.none())
+      return;
+
+    hana::for_each(hana::keys(this->map_), [this](auto e) {
+      if constexpr (is_coalesced(decltype(e){})) {
+        if (!dirty_.test(base::index_of(e)))
+          return;
+        dirty_.reset(base::index_of(e));
+        auto args = *std::move(pending_[e]);
+        pending_[e].reset();
+        for (auto& callback : this->map_[e])
+          std::apply(callback, args);
+      }
+    });
+  }
+  // end-sample
+
+  // sample(pump)
+  // Flushes the coalesced events if at least `window` elapsed since the last
+  // time `pump` flushed them, and returns whether it did.
+  template <typename Rep, typename Period>
+  bool pump(std::chrono::duration<Rep, Period> window) {
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_flush_ < window)
+      return false;
+
+    last_flush_ = now;
+    flush();
+    return true;
+  }
+  // end-sample
+};
+
+// sample(constructor)
+template <typename ...Events>
+coalescing_event_system<Events...> make_coalescing_event_system(Events ...events) {
+  return {};
+}
+// end-sample
+
+#endif
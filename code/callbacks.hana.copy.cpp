@@ -0,0 +1,60 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#include "callbacks.hana.hpp"
+
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+namespace hana = boost::hana;
+using namespace hana::literals;
+
+
+using Events = decltype(make_event_system("connect"_s, "data"_s, "disconnect"_s));
+
+int main() {
+  // The index of the event names is shared by all the instances, so an event
+  // system only holds its callbacks.
+  static_assert(sizeof(Events) == sizeof(std::vector<Events::Callback>) * 3, "");
+
+  // sample(usage)
+  std::vector<Events> connections(1000); // no allocation
+  int data = 0;
+  for (auto& connection : connections)
+    connection.on("data"_s, [&] { ++data; });
+
+  Events copy = connections[0];
+  Events moved = std::move(connections[1]);
+  copy.trigger(std::string{"data"}); // looks up the copy's callbacks
+  moved.trigger(std::string_view{"data"});
+  // end-sample
+  assert(data == 2);
+
+  // Names are looked up in a table sorted at compile-time, no matter the
+  // order in which the events were declared.
+  auto events = make_event_system("zeta"_s, "alpha"_s, "mu"_s, "beta"_s);
+  std::string log;
+  events.on("zeta"_s, [&] { log += 'z'; });
+  events.on("alpha"_s, [&] { log += 'a'; });
+  events.on("mu"_s, [&] { log += 'm'; });
+  events.on("beta"_s, [&] { log += 'b'; });
+  for (std::string_view name : {"mu", "alpha", "zeta", "beta"})
+    events.trigger(name);
+  assert(log == "mazb");
+
+  // Unknown names throw, even those that fall between two known names in
+  // the table or that share a prefix with one.
+  for (std::string_view name : {"", "unknown", "alph", "alphabet", "zz"}) {
+    bool unknown = false;
+    try {
+      events.trigger(name);
+    } catch (std::out_of_range const&) {
+      unknown = true;
+    }
+    assert(unknown);
+  }
+  assert(log == "mazb");
+}
@@ -0,0 +1,58 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#include "callbacks.hana.flat.hpp"
+
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+namespace hana = boost::hana;
+using namespace hana::literals;
+
+
+// sample(usage)
+int main() {
+  auto events = make_event_system("foo"_s, "bar"_s, "baz"_s);
+
+  int foo = 0, bar = 0;
+  events.on("foo"_s, [&]() { std::cout << "foo triggered!" << '\n'; ++foo; });
+  events.on("foo"_s, [&]() { std::cout << "foo again!" << '\n'; ++foo; });
+  events.on("bar"_s, [&]() { std::cout << "bar triggered!" << '\n'; ++bar; });
+  events.on("baz"_s, []() { std::cout << "baz triggered!" << '\n'; });
+  // events.on("unknown"_s, []() { }); // compiler error!
+
+  events.trigger("foo"_s); // no overhead for event lookup
+  events.trigger("baz"_s);
+  // events.trigger("unknown"_s); // compiler error!
+
+  assert(foo == 2 && bar == 0);
+  static_assert(decltype(events)::slot("baz"_s) == 2, "");
+}
+// end-sample
+
+// sample(catalogue-usage)
+struct my_events : decltype(catalogue("foo"_s, "bar"_s, "baz"_s)) { };
+// end-sample
+
+static auto test_catalogue = []{
+  event_system<my_events> events;
+  int foo = 0;
+  events.on("foo"_s, [&]{ ++foo; });
+  events.trigger("foo"_s);
+  events.trigger("bar"_s);
+  assert(foo == 1);
+  static_assert(event_system<my_events>::slot("baz"_s) == 2, "");
+
+  // Events can also be triggered by their name at runtime.
+  events.trigger(std::string{"foo"});
+  assert(foo == 2);
+  bool unknown = false;
+  try {
+    events.trigger(std::string{"unknown"});
+  } catch (std::out_of_range const&) {
+    unknown = true;
+  }
+  assert(unknown);
+  return 0;
+}();
@@ -0,0 +1,193 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#ifndef CODE_CALLBACKS_HANA_FLAT_HPP
+#define CODE_CALLBACKS_HANA_FLAT_HPP
+
+#define BOOST_HANA_CONFIG_ENABLE_STRING_UDL
+#include <boost/hana.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+namespace hana = boost::hana;
+using namespace hana::literals;
+
+
+// This is the same interface as `callbacks.hana.hpp`, but the callbacks are
+// stored in a `std::array` and each event is mapped to its index in that
+// array through a table of event names sorted at compile-time. Looking up
+// an event is then a constexpr binary search, which is much cheaper for the
+// compiler than building a `hana::map` with thousands of keys.
+//
+// The events are gathered in a catalogue, which is the only place where the
+// whole list of events appears. Since any function instantiated with a type
+// mentioning thousands of events gets a huge mangled name, large catalogues
+// should be given a name of their own (see `catalogue` below), which keeps
+// the names of `on` and `trigger` short no matter how many events there are.
+
+namespace detail {
+  // FNV-1a. The table is sorted by hash rather than by name, which keeps
+  // the number of constexpr operations required to sort thousands of names
+  // well under the compiler's limits.
+  constexpr std::uint64_t hash(std::string_view s) {
+    std::uint64_t h = 14695981039346656037ull;
+    for (char c : s) {
+      h ^= static_cast<unsigned char>(c);
+      h *= 1099511628211ull;
+    }
+    return h;
+  }
+
+  struct named_slot {
+    std::uint64_t hash;
+    char const* name;
+    std::size_t slot;
+  };
+
+  template <std::size_t N>
+  struct name_index {
+    std::array<named_slot, N> entries;
+
+    // Returns the slot of the event with the given name, or N if there is
+    // no such event.
+    constexpr std::size_t find(std::string_view name) const {
+      std::uint64_t const h = hash(name);
+      std::size_t first = 0, last = N;
+      while (first != last) {
+        std::size_t middle = first + (last - first) / 2;
+        if (entries[middle].hash < h)
+          first = middle + 1;
+        else
+          last = middle;
+      }
+      for (; first != N && entries[first].hash == h; ++first)
+        if (std::string_view{entries[first].name} == name)
+          return entries[first].slot;
+      return N;
+    }
+
+    constexpr bool has_duplicates() const {
+      for (std::size_t i = 0; i < N; ++i)
+        for (std::size_t j = i + 1; j < N && entries[j].hash == entries[i].hash; ++j)
+          if (std::string_view{entries[i].name} == entries[j].name)
+            return true;
+      return false;
+    }
+  };
+
+  template <std::size_t N>
+  constexpr void sift_down(std::array<named_slot, N>& a, std::size_t root,
+                           std::size_t size)
+  {
+    while (2 * root + 1 < size) {
+      std::size_t child = 2 * root + 1;
+      if (child + 1 < size && a[child].hash < a[child + 1].hash)
+        ++child;
+      if (a[root].hash >= a[child].hash)
+        return;
+      named_slot tmp = a[root];
+      a[root] = a[child];
+      a[child] = tmp;
+      root = child;
+    }
+  }
+
+  // Heap sort, because `std::sort` is not constexpr and the number of
+  // events can be large enough for a quadratic sort to hit the limits of
+  // constexpr evaluation.
+  template <typename ...Events>
+  constexpr name_index<sizeof...(Events)> make_name_index() {
+    constexpr std::size_t N = sizeof...(Events);
+    name_index<N> index{};
+    char const* names[] = {Events::c_str()..., nullptr};
+    for (std::size_t i = 0; i != N; ++i)
+      index.entries[i] = named_slot{hash(names[i]), names[i], i};
+
+    for (std::size_t i = N / 2; i-- > 0; )
+      sift_down(index.entries, i, N);
+    for (std::size_t end = N; end-- > 1; ) {
+      named_slot tmp = index.entries[0];
+      index.entries[0] = index.entries[end];
+      index.entries[end] = tmp;
+      sift_down(index.entries, 0, end);
+    }
+    return index;
+  }
+}
+
+// sample(catalogue)
+template <typename ...Events>
+struct catalogue_t {
+  static constexpr std::size_t size = sizeof...(Events);
+  static constexpr auto index = detail::make_name_index<Events...>();
+  static_assert(!index.has_duplicates(),
+    "the same event was specified more than once");
+};
+
+template <typename ...Events>
+constexpr catalogue_t<Events...> catalogue(Events ...) {
+  return {};
+}
+// end-sample
+
+// sample(struct)
+template <typename Catalogue>
+struct event_system {
+  using Callback = std::function<void()>;
+  std::array<std::vector<Callback>, Catalogue::size> callbacks_;
+// end-sample
+
+// sample(slot)
+template <typename Event>
+static constexpr std::size_t slot(Event) {
+  constexpr std::size_t i = Catalogue::index.find(Event::c_str());
+  static_assert(i != Catalogue::size,
+    "trying to use an unknown event");
+  return i;
+}
+// end-sample
+
+// sample(on)
+template <typename Event, typename F>
+void on(Event e, F callback) {
+  callbacks_[slot(e)].push_back(callback);
+}
+// end-sample
+
+// sample(trigger)
+template <typename Event>
+void trigger(Event e) const {
+  for (auto& callback : callbacks_[slot(e)])
+    callback();
+}
+// end-sample
+
+// Triggers the event with the given name, looked up in the sorted index of
+// the catalogue. Throws `std::out_of_range` if there is no such event.
+void trigger(std::string_view e) const {
+  std::size_t i = Catalogue::index.find(e);
+  if (i == Catalogue::size)
+    throw std::out_of_range{"trying to trigger an unknown event: " + std::string{e}};
+  for (auto& callback : callbacks_[i])
+    callback();
+}
+
+void trigger(std::string const& e) const {
+  trigger(std::string_view{e});
+}
+};
+
+// sample(constructor)
+template <typename ...Events>
+event_system<catalogue_t<Events...>> make_event_system(Events ...events) {
+  return {};
+}
+// end-sample
+
+#endif
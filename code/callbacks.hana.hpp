@@ -7,15 +7,46 @@
 #define BOOST_HANA_CONFIG_ENABLE_STRING_UDL
 #include <boost/hana.hpp>
 
+#include "event_key.hpp"
+
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <stdexcept>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <utility>
 #include <vector>
 namespace hana = boost::hana;
 using namespace hana::literals;
 
 
+namespace detail {
+  // Insertion sort, since std::sort is not constexpr.
+  template <typename Slot, std::size_t N>
+  constexpr std::array<Slot, N> sorted_by_hash(std::array<Slot, N> slots) {
+    for (std::size_t i = 1; i < N; ++i) {
+      for (std::size_t j = i; j != 0 && slots[j].hash < slots[j - 1].hash; --j) {
+        Slot tmp = slots[j];
+        slots[j] = slots[j - 1];
+        slots[j - 1] = tmp;
+      }
+    }
+    return slots;
+  }
+
+  template <typename Slot, std::size_t N>
+  constexpr bool unique_hashes(std::array<Slot, N> const& sorted) {
+    for (std::size_t i = 1; i < N; ++i)
+      if (sorted[i].hash == sorted[i - 1].hash)
+        return false;
+    return true;
+  }
+}
+
 // sample(struct)
 template <typename ...Events>
 struct event_system {
@@ -35,24 +66,57 @@ void on(Event e, F callback) {
 // end-sample
 
 // sample(construct-runtime)
-std::unordered_map<std::string, std::vector<Callback>* const> dynamic_;
+// Index from the hash of the name of each event to its callbacks, sorted by
+// hash. It is built at compile-time and shared by all the instances of this
+// event system, so constructing, copying and moving an event system only
+// deals with the callbacks themselves. The names are kept to check lookups,
+// except for events named by an `event_key`, which only has a hash.
+struct slot {
+  std::uint64_t hash;
+  std::string_view name;
+  std::vector<Callback> const& (*callbacks)(event_system const&);
+};
 
-event_system() {
-  hana::for_each(hana::keys(map_), [&](auto event) {
-    dynamic_.insert({event.c_str(), &map_[event]});
-  });
+template <typename Event>
+static std::vector<Callback> const& callbacks_of(event_system const& self) {
+  return self.map_[Event{}];
+}
+
+static constexpr std::array<slot, sizeof...(Events)> index_ =
+  detail::sorted_by_hash(std::array<slot, sizeof...(Events)>{{
+    slot{detail::key_hash(Events{}), detail::key_name(Events{}), &callbacks_of<Events>}...
+  }});
+
+static_assert(detail::unique_hashes(index_),
+  "two events of this event system have names with the same hash");
+
+// Returns the position in `index_` of the event called `e`, or throws
+// `std::out_of_range` if there is none. An event named by an `event_key` is
+// found by any name with the same hash.
+static std::size_t slot_of(std::string_view e) {
+  std::uint64_t hash = detail::fnv1a(e);
+  auto it = std::lower_bound(index_.begin(), index_.end(), hash,
+    [](slot const& s, std::uint64_t h) { return s.hash < h; });
+  if (it == index_.end() || it->hash != hash ||
+      (it->name.data() != nullptr && it->name != e))
+    throw std::out_of_range{"trying to trigger an unknown event: " + std::string{e}};
+  return static_cast<std::size_t>(it - index_.begin());
+}
+
+std::vector<Callback> const& find(std::string_view e) const {
+  return index_[slot_of(e)].callbacks(*this);
 }
 //end-sample
 
 // sample(trigger-runtime)
-void trigger(std::string const& e) const {
-  auto callbacks = dynamic_.find(e);
-  assert(callbacks != dynamic_.end() &&
-    "trying to trigger an unknown event");
-
-  for (auto& callback : *callbacks->second)
+void trigger(std::string_view e) const {
+  for (auto& callback : find(e))
     callback();
 }
+
+void trigger(std::string const& e) const {
+  trigger(std::string_view{e});
+}
 // end-sample
 
 // sample(trigger)
@@ -66,6 +130,81 @@ void trigger(Event e) const {
     callback();
 }
 // end-sample
+
+// A callback could modify any of the callback vectors, so a sequence of calls
+// to `trigger` reloads each vector after every callback it calls. The batched
+// triggers below read every vector they walk once, before calling anything,
+// so callbacks must not add callbacks to the events being triggered.
+
+// sample(trigger_all)
+// Triggers each of `events`, in order.
+template <typename ...Event>
+void trigger_all(Event ...e) const {
+  static_assert((... && decltype(hana::contains(map_, e))::value),
+    "trying to trigger an unknown event");
+
+  auto spans = hana::make_tuple(
+    std::make_pair(map_[e].data(), map_[e].data() + map_[e].size())...
+  );
+  hana::for_each(spans, [](auto span) {
+    for (Callback const* callback = span.first; callback != span.second; ++callback)
+      (*callback)();
+  });
+}
+// end-sample
+
+// sample(trigger_n)
+// Triggers `e` `count` times in a row.
+template <typename Event>
+void trigger_n(Event e, std::size_t count) const {
+  auto is_known_event = hana::contains(map_, e);
+  static_assert(is_known_event,
+    "trying to trigger an unknown event");
+
+  Callback const* first = map_[e].data();
+  Callback const* last = first + map_[e].size();
+  for (; count != 0; --count)
+    for (Callback const* callback = first; callback != last; ++callback)
+      (*callback)();
+}
+// end-sample
+
+// Calls `f(i, n)` for each event named in `names`, where `i` is its position
+// in `index_` and `n` the number of times it is named, in the order of their
+// first appearance in `names`. Each name is looked up once, and all of them
+// are looked up before `f` is called, so nothing is called if one of the
+// names is unknown.
+template <typename Names, typename F>
+static void group_by_event(Names const& names, F f) {
+  std::array<std::size_t, sizeof...(Events)> counts{};
+  std::array<std::size_t, sizeof...(Events)> order;
+  std::size_t events = 0;
+  for (auto const& name : names) {
+    std::size_t i = slot_of(name);
+    if (counts[i]++ == 0)
+      order[events++] = i;
+  }
+
+  for (std::size_t k = 0; k != events; ++k)
+    f(order[k], counts[order[k]]);
+}
+
+// sample(trigger_batch)
+// Triggers the events named by `names`, grouped by event: each event is
+// triggered as many times as it is named, in the order of its first
+// appearance in `names`.
+template <typename Names>
+void trigger_batch(Names const& names) const {
+  group_by_event(names, [this](std::size_t i, std::size_t n) {
+    auto const& callbacks = index_[i].callbacks(*this);
+    Callback const* begin = callbacks.data();
+    Callback const* end = begin + callbacks.size();
+    for (; n != 0; --n)
+      for (Callback const* callback = begin; callback != end; ++callback)
+        (*callback)();
+  });
+}
+// end-sample
 };
 
 // sample(constructor)
@@ -0,0 +1,75 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#include "callbacks.hana.parallel.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+namespace hana = boost::hana;
+using namespace hana::literals;
+
+
+int main() {
+  thread_pool pool{4};
+
+  // sample(usage)
+  auto events = make_parallel_event_system(pool, "frame"_s, "tick"_s);
+  events.parallel("frame"_s, 4);
+
+  std::atomic<int> rendered{0};
+  for (int layer = 0; layer != 16; ++layer)
+    events.on("frame"_s, [&] { ++rendered; });
+
+  events.trigger("frame"_s);             // fans out, then joins
+  join_handle frame = events.trigger_async("frame"_s);
+  // ... do something else in the meantime ...
+  frame.join();
+  // end-sample
+  assert(rendered == 32);
+
+  // Events with fewer callbacks than their threshold, or which did not opt
+  // in, run their callbacks inline and in order.
+  std::thread::id caller = std::this_thread::get_id();
+  int ticks = 0;
+  events.on("tick"_s, [&] { assert(std::this_thread::get_id() == caller); ++ticks; });
+  events.on("tick"_s, [&] { assert(ticks % 2 == 1); ++ticks; });
+  join_handle tick = events.trigger_async("tick"_s);
+  assert(!tick.joinable());
+  assert(ticks == 2);
+
+  // Exceptions thrown by the callbacks are rethrown when joining.
+  events.on("frame"_s, [] { throw std::runtime_error{"lost device"}; });
+  bool thrown = false;
+  try {
+    events.trigger("frame"_s);
+  } catch (std::runtime_error const&) {
+    thrown = true;
+  }
+  assert(thrown);
+  assert(rendered == 48);
+
+  // Triggering by name and the batched triggers follow the policy of each
+  // event too.
+  events.trigger(std::string{"tick"});
+  assert(ticks == 4);
+  thrown = false;
+  try {
+    events.trigger_batch(std::vector<std::string>{"tick", "frame"});
+  } catch (std::runtime_error const&) {
+    thrown = true;
+  }
+  assert(thrown && ticks == 6 && rendered == 64); // "frame" throws after "tick"
+
+  // Forking from a job of the pool does not deadlock, even with a single
+  // worker.
+  thread_pool single{1};
+  std::atomic<int> leaves{0};
+  single.parallel_for(4, [&](std::size_t) {
+    single.parallel_for(4, [&](std::size_t) { ++leaves; });
+  });
+  assert(leaves == 16);
+}
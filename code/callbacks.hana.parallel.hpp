@@ -0,0 +1,125 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#ifndef CODE_CALLBACKS_HANA_PARALLEL_HPP
+#define CODE_CALLBACKS_HANA_PARALLEL_HPP
+
+#include "callbacks.hana.hpp"
+#include "thread_pool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+namespace hana = boost::hana;
+
+
+// This is the same thing as `callbacks.hana.hpp`, except the callbacks of an
+// event can be run in parallel on a `thread_pool`.
+//
+// Running the callbacks of an event in parallel is opted into for each event,
+// with the minimum number of callbacks for which it is worth it. When an event
+// has fewer callbacks, or did not opt in, its callbacks run one after another
+// on the triggering thread as usual. The callbacks of such events must not
+// depend on each other's side effects, since they may run in any order and at
+// the same time, and callbacks must not be added to an event while it is
+// being triggered.
+
+namespace detail {
+  struct fan_out_policy {
+    std::size_t threshold = std::numeric_limits<std::size_t>::max();
+  };
+}
+
+// sample(struct)
+template <typename ...Events>
+struct parallel_event_system : event_system<Events...> {
+  using Callback = typename event_system<Events...>::Callback;
+  thread_pool* pool_;
+  hana::map<hana::pair<Events, detail::fan_out_policy>...> policies_;
+// end-sample
+
+// sample(parallel)
+// Runs the callbacks of `e` in parallel whenever it has at least `threshold`
+// callbacks.
+template <typename Event>
+void parallel(Event e, std::size_t threshold = 2) {
+  auto is_known_event = hana::contains(policies_, e);
+  static_assert(is_known_event,
+    "trying to set the policy of an unknown event");
+
+  policies_[e].threshold = threshold;
+}
+// end-sample
+
+// sample(trigger)
+template <typename Event>
+void trigger(Event e) const {
+  trigger_async(e).join();
+}
+
+// Starts running the callbacks of `e` in parallel and returns a handle to
+// join them, or runs them right away and returns an empty handle if `e` has
+// fewer callbacks than its threshold.
+template <typename Event>
+join_handle trigger_async(Event e) const {
+  auto is_known_event = hana::contains(policies_, e);
+  static_assert(is_known_event,
+    "trying to trigger an unknown event");
+
+  auto const& callbacks = this->map_[e];
+  if (callbacks.size() < policies_[e].threshold) {
+    for (auto& callback : callbacks)
+      callback();
+    return join_handle{};
+  }
+
+  Callback const* first = callbacks.data();
+  return pool_->fork(callbacks.size(), [first](std::size_t i) { first[i](); });
+}
+// end-sample
+
+// The triggers below replace the ones of `event_system`, so that they follow
+// the policy of each event they trigger.
+void trigger(std::string_view e) const {
+  trigger_hash(this->index_[this->slot_of(e)].hash);
+}
+
+void trigger_hash(std::uint64_t hash) const {
+  hana::for_each(hana::keys(policies_), [&](auto event) {
+    if (detail::key_hash(event) == hash)
+      trigger(event);
+  });
+}
+
+void trigger(std::string const& e) const {
+  trigger(std::string_view{e});
+}
+
+template <typename ...Event>
+void trigger_all(Event ...e) const {
+  (trigger(e), ...);
+}
+
+template <typename Event>
+void trigger_n(Event e, std::size_t count) const {
+  for (; count != 0; --count)
+    trigger(e);
+}
+
+template <typename Names>
+void trigger_batch(Names const& names) const {
+  this->group_by_event(names, [this](std::size_t i, std::size_t n) {
+    for (; n != 0; --n)
+      trigger_hash(this->index_[i].hash);
+  });
+}
+};
+
+template <typename ...Events>
+parallel_event_system<Events...> make_parallel_event_system(thread_pool& pool, Events ...events) {
+  return {{}, &pool, {}};
+}
+
+#endif
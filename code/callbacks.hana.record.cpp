@@ -0,0 +1,151 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#include "callbacks.hana.record.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+namespace hana = boost::hana;
+using namespace std::literals;
+
+
+auto declare_events() {
+  return make_event_system(
+    "log"_e = function<void(std::string)>,
+    "tick"_e = function<void(int, double)>,
+    "reset"_e = function<void()>
+  );
+}
+
+using seen = std::vector<std::string>;
+
+template <typename Events>
+void observe(Events& events, seen& out) {
+  events.on("log"_e, [&](std::string s) { out.push_back("log " + s); });
+  events.on("tick"_e, [&](int i, double d) {
+    out.push_back("tick " + std::to_string(i) + " " + std::to_string(d));
+  });
+  events.on("reset"_e, [&] { out.push_back("reset"); });
+}
+
+int main() {
+  std::string path = "/tmp/cppnow-callbacks-" + std::to_string(::getpid());
+
+  seen live, replayed;
+  {
+    // sample(usage)
+    auto events = declare_events();
+    observe(events, live);
+
+    event_log log{path + ".log", 1 << 20};
+    auto recording = record_to(log, events);
+    recording.trigger("log"_e, "starting"s);
+    for (int i = 0; i != 100; ++i)
+      recording.trigger("tick"_e, i, i / 2.0);
+    recording.trigger("reset"_e);
+    // end-sample
+    assert(log.dropped() == 0);
+  }
+
+  // sample(replay)
+  event_log_reader reader{path + ".log"};
+  auto events = declare_events();
+  observe(events, replayed);
+  std::size_t count = replay(reader, events);
+  // end-sample
+  assert(count == 102);
+  assert(live.size() == 102);
+  assert(replayed == live);
+
+  // The timestamps are in the order of the triggers.
+  std::uint64_t last = 0;
+  reader.for_each([&](event_record const& record) {
+    assert(record.timestamp >= last);
+    last = record.timestamp;
+  });
+
+  // Each thread records to its own log.
+  {
+    std::vector<std::thread> threads;
+    for (int t = 0; t != 2; ++t) {
+      threads.emplace_back([&, t] {
+        auto events = declare_events();
+        event_log log{path + "." + std::to_string(t) + ".log", 1 << 16};
+        auto recording = record_to(log, events);
+        for (int i = 0; i != 1000; ++i)
+          recording.trigger("tick"_e, t, double(i));
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+
+    for (int t = 0; t != 2; ++t) {
+      event_log_reader reader{path + "." + std::to_string(t) + ".log"};
+      auto events = declare_events();
+      int next = 0;
+      events.on("tick"_e, [&](int thread, double i) {
+        assert(thread == t && i == next);
+        ++next;
+      });
+      assert(replay(reader, events) == 1000);
+      assert(next == 1000);
+      std::remove((path + "." + std::to_string(t) + ".log").c_str());
+    }
+  }
+
+  // A full log drops the records that do not fit, but still triggers them.
+  {
+    auto events = declare_events();
+    int ticks = 0;
+    events.on("tick"_e, [&](int, double) { ++ticks; });
+    event_log log{path + ".small.log", 1000};
+    auto recording = record_to(log, events);
+    for (int i = 0; i != 100; ++i)
+      recording.trigger("tick"_e, i, 0.0);
+    assert(ticks == 100);
+    assert(log.dropped() > 0);
+    assert(log.size() <= 1000);
+  }
+  {
+    event_log_reader reader{path + ".small.log"};
+    auto events = declare_events();
+    assert(replay(reader, events) + reader.dropped() == 100);
+  }
+
+  // Corrupted logs are reported instead of being read past their end.
+  auto corrupt = [&](std::size_t offset, std::uint32_t value) {
+    std::FILE* file = std::fopen((path + ".log").c_str(), "r+b");
+    assert(file);
+    std::fseek(file, static_cast<long>(offset), SEEK_SET);
+    std::fwrite(&value, sizeof(value), 1, file);
+    std::fclose(file);
+  };
+  auto throws = [&](auto f) {
+    try { f(); } catch (std::runtime_error const&) { return true; }
+    return false;
+  };
+  std::size_t first = sizeof(detail::log_header);
+  corrupt(first + offsetof(detail::record_header, event), 2); // "log" recorded as "reset"
+  {
+    event_log_reader reader{path + ".log"};
+    auto events = declare_events();
+    assert(throws([&] { replay(reader, events); }));
+  }
+  corrupt(first + offsetof(detail::record_header, size), 0xffffffff);
+  {
+    event_log_reader reader{path + ".log"};
+    assert(throws([&] { reader.for_each([](event_record const&) { }); }));
+  }
+
+  std::remove((path + ".log").c_str());
+  std::remove((path + ".small.log").c_str());
+}
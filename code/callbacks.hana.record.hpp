@@ -0,0 +1,114 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#ifndef CODE_CALLBACKS_HANA_RECORD_HPP
+#define CODE_CALLBACKS_HANA_RECORD_HPP
+
+#include "callbacks.hana.hetero.hpp"
+#include "callbacks.hana.wire.hpp"
+#include "callbacks.log.hpp"
+
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+namespace hana = boost::hana;
+
+
+// Recording of the events triggered on an `event_system` of
+// `callbacks.hana.hetero.hpp`, to find out what happened in production and to
+// replay it later, e.g. as the input of a benchmark.
+//
+// Each thread records to its own `event_log` (see `callbacks.log.hpp`), a file
+// mapped in memory and allocated up front. A record is the index of the event
+// in the declaration of the event system, a timestamp and the arguments
+// encoded as described in `callbacks.hana.wire.hpp`. Recording an event costs
+// a read of the clock and a copy of its arguments; it never allocates nor
+// makes a system call. Once the log is full, further records are dropped and
+// counted.
+
+// sample(recorder)
+template <typename EventSystem>
+class recorder;
+
+template <typename ...Events, typename ...Signatures>
+class recorder<event_system<hana::pair<Events, hana::basic_type<Signatures>>...>> {
+  using EventSystem = event_system<hana::pair<Events, hana::basic_type<Signatures>>...>;
+  EventSystem const& events_;
+  event_log& log_;
+// end-sample
+
+  template <typename Event>
+  using signature_of =
+    std::tuple_element_t<EventSystem::index_of(Event{}), std::tuple<Signatures...>>;
+
+public:
+  recorder(EventSystem const& events, event_log& log)
+    : events_(events), log_(log)
+  { }
+
+// sample(record)
+  // Records the event to the log of this recorder, and then triggers it.
+  template <typename Event, typename ...Args>
+  void trigger(Event e, Args const& ...args) const {
+    auto is_known_event = hana::contains(events_.map_, e);
+    static_assert(is_known_event,
+      "trying to trigger an unknown event");
+
+    using Message = detail::message<signature_of<Event>, 0>;
+    log_.append(EventSystem::index_of(e), Message::size(args...), [&](unsigned char* out) {
+      Message::write(out, args...);
+    });
+    events_.trigger(e, args...);
+  }
+// end-sample
+};
+
+// sample(record_to)
+// Records the events triggered through the returned recorder to `log`. Each
+// thread triggering events should use its own log, and hence its own recorder.
+template <typename EventSystem>
+recorder<EventSystem> record_to(event_log& log, EventSystem const& events) {
+  return {events, log};
+}
+// end-sample
+
+namespace detail {
+  template <typename Event, typename Signature, typename EventSystem>
+  void replay_one(EventSystem const& events, unsigned char const* in, std::size_t size) {
+    if (!message<Signature, 0>::is_valid(in, size))
+      throw std::runtime_error{"the event log was not recorded from this event system"};
+    std::apply([&](auto&& ...args) {
+      events.trigger(Event{}, std::move(args)...);
+    }, message<Signature, 0>::read(in));
+  }
+}
+
+// sample(replay)
+// Triggers the events of `log` on `events` one after the other, as fast as
+// possible, and returns the number of events triggered. The event system must
+// be declared with the same events, in the same order, as the one that was
+// recorded; a record that does not match the signature of its event throws
+// `std::runtime_error`.
+template <typename ...Events, typename ...Signatures>
+std::size_t replay(event_log_reader const& log,
+                   event_system<hana::pair<Events, hana::basic_type<Signatures>>...> const& events)
+{
+  using EventSystem = event_system<hana::pair<Events, hana::basic_type<Signatures>>...>;
+  using Trigger = void (*)(EventSystem const&, unsigned char const*, std::size_t);
+  static constexpr Trigger triggers[] = {
+    &detail::replay_one<Events, Signatures, EventSystem>...
+  };
+
+  std::size_t replayed = 0;
+  log.for_each([&](event_record const& record) {
+    if (record.event >= sizeof...(Events))
+      throw std::runtime_error{"the event log was not recorded from this event system"};
+    triggers[record.event](events, record.arguments, record.size);
+    ++replayed;
+  });
+  return replayed;
+}
+// end-sample
+
+#endif
@@ -0,0 +1,117 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#include "callbacks.hana.shm.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+namespace hana = boost::hana;
+
+
+// sample(declare)
+auto declare_events() {
+  return hana::make_tuple(
+    "log"_e = function<void(std::string)>,
+    "tick"_e = function<void(int, int)>
+  );
+}
+// end-sample
+
+template <typename ...Events>
+auto open_channel(std::string const& name, hana::tuple<Events...>) {
+  return make_shm_channel<64>(name, Events{}...);
+}
+
+constexpr int ticks = 10000;
+
+int produce(std::string const& name, int producer) {
+  auto channel = open_channel(name, declare_events());
+  for (int i = 0; i != ticks; ++i) {
+    while (!channel.publish("tick"_e, producer, i))
+      std::this_thread::yield();
+  }
+  while (!channel.publish("log"_e, "producer " + std::to_string(producer) + " done"))
+    std::this_thread::yield();
+  return 0;
+}
+
+int main() {
+  std::string name = "/cppnow-callbacks-" + std::to_string(::getpid());
+
+  // sample(usage)
+  auto channel = open_channel(name, declare_events());
+  auto events = hana::unpack(declare_events(), [](auto ...e) {
+    return make_event_system(e...);
+  });
+
+  std::vector<int> next(2, 0);
+  std::vector<std::string> logs;
+  events.on("tick"_e, [&](int producer, int i) {
+    assert(next[producer] == i); // messages of a producer arrive in order
+    ++next[producer];
+  });
+  events.on("log"_e, [&](std::string message) { logs.push_back(message); });
+  // end-sample
+
+  std::vector<pid_t> producers;
+  for (int producer = 0; producer != 2; ++producer) {
+    pid_t pid = ::fork();
+    assert(pid != -1);
+    if (pid == 0)
+      ::_exit(produce(name, producer));
+    producers.push_back(pid);
+  }
+
+  while (logs.size() != 2) {
+    if (channel.poll(events) == 0)
+      std::this_thread::yield();
+  }
+
+  for (pid_t pid : producers) {
+    int status;
+    ::waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  }
+  channel.unlink();
+
+  assert(next[0] == ticks && next[1] == ticks);
+  assert(logs.size() == 2);
+  for (auto const& log : logs)
+    assert(log == "producer 0 done" || log == "producer 1 done");
+
+  // A process that dies while initializing a segment leaves it to the next
+  // process opening it.
+  std::string orphan = name + "-orphan";
+  pid_t initializer = ::fork();
+  assert(initializer != -1);
+  if (initializer == 0) {
+    using Segment = detail::segment<64, 256, void(std::string), void(int, int)>;
+    int fd = ::shm_open(orphan.c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd == -1 || ::ftruncate(fd, sizeof(Segment)) == -1)
+      ::_exit(1);
+    void* memory = ::mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED)
+      ::_exit(1);
+    static_cast<Segment*>(memory)->state.store(::getpid());
+    ::_exit(0); // before the rings are constructed
+  }
+  int status;
+  ::waitpid(initializer, &status, 0);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  auto recovered = open_channel(orphan, declare_events());
+  recovered.unlink();
+  bool published = recovered.publish("log"_e, std::string{"recovered"});
+  assert(published);
+  std::size_t polled = recovered.poll(events);
+  assert(polled == 1);
+  assert(logs.size() == 3 && logs.back() == "recovered");
+}
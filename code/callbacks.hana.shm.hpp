@@ -0,0 +1,259 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#ifndef CODE_CALLBACKS_HANA_SHM_HPP
+#define CODE_CALLBACKS_HANA_SHM_HPP
+
+#include "callbacks.hana.hetero.hpp"
+#include "callbacks.hana.wire.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cerrno>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+namespace hana = boost::hana;
+
+
+// Transport for the events of `callbacks.hana.hetero.hpp` between processes
+// running on the same host. Each event gets a lock-free ring of messages in
+// a named shared-memory segment (`shm_open` + `mmap`), which any number of
+// processes can publish to and poll from.
+//
+// The layout of the messages of an event is derived from its signature at
+// compile-time (see `callbacks.hana.wire.hpp`). Trivially copyable arguments
+// are copied once into the ring, and `std::string` arguments are written in
+// place, up to `MaxString` characters. Both sides of a channel must be
+// declared with the same events, signatures and parameters.
+
+namespace detail {
+  // Bounded multi-producer multi-consumer queue of Dmitry Vyukov. Each cell
+  // carries a sequence number telling whether it is ready to be written to
+  // or read from at a given position, so producers and consumers only ever
+  // contend on the position counters.
+  template <std::size_t Capacity, std::size_t MessageSize>
+  struct ring {
+    static_assert((Capacity & (Capacity - 1)) == 0,
+      "the capacity of a ring must be a power of 2");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+      "shared-memory rings require lock-free 64 bits atomics");
+
+    struct alignas(64) cell {
+      std::atomic<std::uint64_t> sequence;
+      std::uint32_t size;
+      unsigned char data[MessageSize == 0 ? 1 : MessageSize];
+    };
+
+    alignas(64) std::atomic<std::uint64_t> enqueue_;
+    alignas(64) std::atomic<std::uint64_t> dequeue_;
+    cell cells_[Capacity];
+
+    ring() : enqueue_(0), dequeue_(0) {
+      for (std::size_t i = 0; i != Capacity; ++i)
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    template <typename Write>
+    bool try_push(std::size_t size, Write write) {
+      std::uint64_t pos = enqueue_.load(std::memory_order_relaxed);
+      while (true) {
+        cell& c = cells_[pos & (Capacity - 1)];
+        std::uint64_t seq = c.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::int64_t>(seq - pos);
+        if (diff == 0) {
+          if (enqueue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+            write(c.data);
+            c.size = static_cast<std::uint32_t>(size);
+            c.sequence.store(pos + 1, std::memory_order_release);
+            return true;
+          }
+        } else if (diff < 0) {
+          return false; // full
+        } else {
+          pos = enqueue_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    template <typename Read>
+    bool try_pop(Read read) {
+      std::uint64_t pos = dequeue_.load(std::memory_order_relaxed);
+      while (true) {
+        cell& c = cells_[pos & (Capacity - 1)];
+        std::uint64_t seq = c.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::int64_t>(seq - (pos + 1));
+        if (diff == 0) {
+          if (dequeue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+            read(static_cast<unsigned char const*>(c.data), c.size);
+            c.sequence.store(pos + Capacity, std::memory_order_release);
+            return true;
+          }
+        } else if (diff < 0) {
+          return false; // empty
+        } else {
+          pos = dequeue_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+  };
+
+  // The state of a segment is either `uninitialized`, `ready`, or the pid of
+  // the process initializing it, so a process that dies while initializing
+  // the segment can be told apart from one that is just slow.
+  template <std::size_t Capacity, std::size_t MaxString, typename ...Signatures>
+  struct segment {
+    enum : std::uint64_t { uninitialized = 0, ready = ~std::uint64_t{0} };
+    std::atomic<std::uint64_t> state;
+    std::tuple<ring<Capacity, message<Signatures, MaxString>::max_size>...> rings;
+  };
+
+  inline bool is_alive(std::uint64_t pid) {
+    return ::kill(static_cast<pid_t>(pid), 0) == 0 || errno != ESRCH;
+  }
+}
+
+// sample(channel)
+template <std::size_t Capacity, std::size_t MaxString, typename ...Events>
+class shm_channel;
+
+template <std::size_t Capacity, std::size_t MaxString,
+          typename ...Events, typename ...Signatures>
+class shm_channel<Capacity, MaxString, hana::pair<Events, hana::basic_type<Signatures>>...> {
+  using Segment = detail::segment<Capacity, MaxString, Signatures...>;
+  std::string name_;
+  Segment* segment_;
+// end-sample
+
+  template <typename Event>
+  static constexpr std::size_t index_of(Event) {
+    constexpr bool matches[] = {std::is_same<Event, Events>::value...};
+    std::size_t i = 0;
+    while (i != sizeof...(Events) && !matches[i]) ++i;
+    return i;
+  }
+
+  template <typename Event>
+  using signature_of =
+    std::tuple_element_t<index_of(Event{}), std::tuple<Signatures...>>;
+
+public:
+  // Opens the segment called `name`, creating and initializing it if this is
+  // the first process to open it. The segment stays around until `unlink()`
+  // is called, even when no process has it open.
+  explicit shm_channel(std::string name) : name_(std::move(name)) {
+    int fd = ::shm_open(name_.c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd == -1)
+      throw std::system_error{errno, std::generic_category(), "shm_open " + name_};
+
+    auto fail = [&](int error, std::string const& what) {
+      ::close(fd);
+      throw std::system_error{error, std::generic_category(), what};
+    };
+    struct stat st;
+    if (::fstat(fd, &st) == -1)
+      fail(errno, "fstat " + name_);
+    if (st.st_size == 0 && ::ftruncate(fd, sizeof(Segment)) == -1)
+      fail(errno, "ftruncate " + name_);
+    if (st.st_size != 0 && st.st_size != sizeof(Segment))
+      fail(EINVAL, "shared-memory segment " + name_ + " does not match this channel");
+
+    void* memory = ::mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED)
+      throw std::system_error{errno, std::generic_category(), "mmap " + name_};
+    segment_ = static_cast<Segment*>(memory);
+
+    // A new segment is filled with zeros, so exactly one process sees it
+    // uninitialized and constructs the rings, while the others wait for it.
+    // If that process dies before it is done, the first process to notice
+    // takes over and constructs the rings again. (A pid reused by another
+    // process in the meantime keeps the others waiting.)
+    std::uint64_t const self = static_cast<std::uint64_t>(::getpid());
+    std::uint64_t state = Segment::uninitialized;
+    while (!segment_->state.compare_exchange_strong(state, self)) {
+      if (state == Segment::ready)
+        return;
+      if (state != Segment::uninitialized && detail::is_alive(state)) {
+        std::this_thread::yield();
+        state = Segment::uninitialized;
+      }
+    }
+    new (&segment_->rings) decltype(segment_->rings)();
+    segment_->state.store(Segment::ready, std::memory_order_release);
+  }
+
+  shm_channel(shm_channel const&) = delete;
+  shm_channel& operator=(shm_channel const&) = delete;
+
+  ~shm_channel() { ::munmap(segment_, sizeof(Segment)); }
+
+  void unlink() const { ::shm_unlink(name_.c_str()); }
+
+// sample(publish)
+  // Sends an event to the processes polling this channel. Returns false if
+  // the ring of that event is full, or if the message does not fit in it.
+  template <typename Event, typename ...Args>
+  bool publish(Event e, Args const& ...args) {
+    static_assert(index_of(Event{}) != sizeof...(Events),
+      "trying to publish an unknown event");
+    using Message = detail::message<signature_of<Event>, MaxString>;
+
+    auto& ring = std::get<index_of(Event{})>(segment_->rings);
+    std::size_t size = Message::size(args...);
+    if (size > Message::max_size)
+      return false;
+    return ring.try_push(size, [&](unsigned char* out) {
+      Message::write(out, args...);
+    });
+  }
+// end-sample
+
+// sample(poll)
+  // Triggers on `events` the events received since the last call, in the
+  // order in which they were published for each event. Only the events
+  // declared by `events` are received, so several processes can exchange
+  // different events through the same channel. Returns the number of events
+  // triggered.
+  template <typename EventSystem>
+  std::size_t poll(EventSystem const& events) {
+    std::size_t received = 0;
+    hana::for_each(hana::make_tuple(Events{}...), [&](auto e) {
+      if constexpr (decltype(hana::contains(events.map_, e))::value) {
+        using Message = detail::message<signature_of<decltype(e)>, MaxString>;
+        auto& ring = std::get<index_of(decltype(e){})>(segment_->rings);
+        std::optional<typename Message::arguments> args;
+        while (ring.try_pop([&](unsigned char const* in, std::size_t) {
+          args.emplace(Message::read(in));
+        })) {
+          std::apply([&](auto&& ...a) { events.trigger(e, std::move(a)...); }, std::move(*args));
+          ++received;
+        }
+      }
+    });
+    return received;
+  }
+// end-sample
+};
+
+// sample(make_shm_channel)
+template <std::size_t Capacity = 1024, std::size_t MaxString = 256, typename ...Events>
+shm_channel<Capacity, MaxString, Events...>
+make_shm_channel(std::string name, Events ...events) {
+  return shm_channel<Capacity, MaxString, Events...>{std::move(name)};
+}
+// end-sample
+
+#endif
@@ -0,0 +1,115 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#ifndef CODE_CALLBACKS_HANA_WIRE_HPP
+#define CODE_CALLBACKS_HANA_WIRE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+
+// Binary encoding of the arguments of an event, derived from its signature
+// at compile-time. Trivially copyable arguments are copied as they are, and
+// `std::string` arguments are written as their length followed by their
+// characters. This is used to send events to other processes and to record
+// them to a file.
+
+namespace detail {
+  template <typename T>
+  struct wire {
+    static_assert(std::is_trivially_copyable<T>::value,
+      "only trivially copyable types and std::string can be encoded");
+
+    static constexpr std::size_t max_size(std::size_t) { return sizeof(T); }
+    static std::size_t size(T const&) { return sizeof(T); }
+    static unsigned char* write(unsigned char* out, T const& t) {
+      std::memcpy(out, &t, sizeof(T));
+      return out + sizeof(T);
+    }
+    static bool skip(unsigned char const*& in, unsigned char const* end) {
+      if (static_cast<std::size_t>(end - in) < sizeof(T))
+        return false;
+      in += sizeof(T);
+      return true;
+    }
+    static T read(unsigned char const*& in) {
+      T t;
+      std::memcpy(&t, in, sizeof(T));
+      in += sizeof(T);
+      return t;
+    }
+  };
+
+  template <>
+  struct wire<std::string> {
+    static constexpr std::size_t max_size(std::size_t max_string) {
+      return sizeof(std::uint32_t) + max_string;
+    }
+    static std::size_t size(std::string_view s) {
+      return sizeof(std::uint32_t) + s.size();
+    }
+    static unsigned char* write(unsigned char* out, std::string_view s) {
+      std::uint32_t length = static_cast<std::uint32_t>(s.size());
+      std::memcpy(out, &length, sizeof(length));
+      std::memcpy(out + sizeof(length), s.data(), s.size());
+      return out + sizeof(length) + s.size();
+    }
+    static bool skip(unsigned char const*& in, unsigned char const* end) {
+      std::uint32_t length;
+      if (static_cast<std::size_t>(end - in) < sizeof(length))
+        return false;
+      std::memcpy(&length, in, sizeof(length));
+      if (static_cast<std::size_t>(end - in) - sizeof(length) < length)
+        return false;
+      in += sizeof(length) + length;
+      return true;
+    }
+    static std::string read(unsigned char const*& in) {
+      std::uint32_t length;
+      std::memcpy(&length, in, sizeof(length));
+      std::string s(reinterpret_cast<char const*>(in + sizeof(length)), length);
+      in += sizeof(length) + length;
+      return s;
+    }
+  };
+
+  template <typename Signature, std::size_t MaxString>
+  struct message;
+
+  template <typename R, typename ...Args, std::size_t MaxString>
+  struct message<R(Args...), MaxString> {
+    using arguments = std::tuple<std::decay_t<Args>...>;
+    static constexpr std::size_t max_size =
+      (std::size_t{0} + ... + wire<std::decay_t<Args>>::max_size(MaxString));
+
+    template <typename ...T>
+    static std::size_t size(T const& ...t) {
+      return (std::size_t{0} + ... + wire<std::decay_t<Args>>::size(t));
+    }
+
+    template <typename ...T>
+    static void write([[maybe_unused]] unsigned char* out, T const& ...t) {
+      ((out = wire<std::decay_t<Args>>::write(out, t)), ...);
+    }
+
+    // Returns whether the `size` bytes at `in` are exactly the encoding of
+    // some arguments, so that `read` stays within them.
+    static bool is_valid([[maybe_unused]] unsigned char const* in, std::size_t size) {
+      unsigned char const* end = in + size;
+      return (true && ... && wire<std::decay_t<Args>>::skip(in, end)) && in == end;
+    }
+
+    // The arguments are read in order, since the elements of a braced
+    // initializer list are evaluated from left to right.
+    static arguments read([[maybe_unused]] unsigned char const* in) {
+      return arguments{wire<std::decay_t<Args>>::read(in)...};
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,220 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#ifndef CODE_CALLBACKS_LOG_HPP
+#define CODE_CALLBACKS_LOG_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+// Binary log of the events triggered by a thread, written by the recorder of
+// `callbacks.hana.record.hpp`. It does not depend on any event system, so
+// tools and benchmarks can read logs without knowing how they were recorded.
+//
+// The file starts with a `detail::log_header`, followed by the records. Each
+// record is a `detail::record_header` followed by the encoded arguments of
+// the event.
+
+namespace detail {
+  constexpr char log_magic[8] = {'h', 'a', 'n', 'a', '.', 'l', 'o', 'g'};
+
+  struct log_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t size;    // bytes of records following the header
+    std::uint64_t dropped; // records that did not fit in the log
+  };
+
+  struct record_header {
+    std::uint32_t size;      // bytes of arguments following the record header
+    std::uint32_t event;     // index of the event in the event system
+    std::uint64_t timestamp; // std::chrono::steady_clock, in nanoseconds
+  };
+}
+
+// sample(event_log)
+// Log of the events recorded by a single thread. The file is created with
+// room for `capacity` bytes of records, and is truncated to the records
+// actually written when the log is destroyed. Since the log lives in a shared
+// mapping, the records written before a crash are still in the file.
+class event_log {
+  unsigned char* memory_;
+  std::size_t mapped_;
+  int fd_;
+  detail::log_header* header_;
+  unsigned char* next_;
+  unsigned char* end_;
+// end-sample
+
+public:
+  event_log(std::string const& path, std::size_t capacity)
+    : mapped_(sizeof(detail::log_header) + capacity)
+  {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ == -1)
+      throw std::system_error{errno, std::generic_category(), "open " + path};
+    if (::ftruncate(fd_, mapped_) == -1) {
+      int error = errno;
+      ::close(fd_);
+      throw std::system_error{error, std::generic_category(), "ftruncate " + path};
+    }
+
+    // Populating the mapping right away keeps page faults out of recording.
+    int flags = MAP_SHARED;
+#if defined(MAP_POPULATE)
+    flags |= MAP_POPULATE;
+#endif
+    void* memory = ::mmap(nullptr, mapped_, PROT_READ | PROT_WRITE, flags, fd_, 0);
+    if (memory == MAP_FAILED) {
+      int error = errno;
+      ::close(fd_);
+      throw std::system_error{error, std::generic_category(), "mmap " + path};
+    }
+
+    memory_ = static_cast<unsigned char*>(memory);
+    header_ = reinterpret_cast<detail::log_header*>(memory_);
+    std::memcpy(header_->magic, detail::log_magic, sizeof(detail::log_magic));
+    header_->version = 1;
+    next_ = memory_ + sizeof(detail::log_header);
+    end_ = memory_ + mapped_;
+  }
+
+  event_log(event_log const&) = delete;
+  event_log& operator=(event_log const&) = delete;
+
+  ~event_log() {
+    std::size_t used = sizeof(detail::log_header) + header_->size;
+    ::munmap(memory_, mapped_);
+    (void)::ftruncate(fd_, used);
+    ::close(fd_);
+  }
+
+  std::uint64_t size() const { return header_->size; }
+  std::uint64_t dropped() const { return header_->dropped; }
+
+// sample(append)
+  // Appends a record of `event` whose `size` bytes of arguments are written
+  // by `write(out)`. Returns false, and only counts the record, if it does
+  // not fit in the log.
+  template <typename Write>
+  bool append(std::uint32_t event, std::size_t size, Write write) {
+    std::size_t total = sizeof(detail::record_header) + size;
+    if (static_cast<std::size_t>(end_ - next_) < total) {
+      ++header_->dropped;
+      return false;
+    }
+
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    detail::record_header record{
+      static_cast<std::uint32_t>(size), event,
+      static_cast<std::uint64_t>(std::chrono::nanoseconds{now}.count())
+    };
+    std::memcpy(next_, &record, sizeof(record));
+    write(next_ + sizeof(record));
+    next_ += total;
+    header_->size += total;
+    return true;
+  }
+// end-sample
+};
+
+// A recorded event, pointing into the memory of an `event_log_reader`.
+struct event_record {
+  std::uint32_t event;
+  std::uint64_t timestamp;
+  unsigned char const* arguments;
+  std::size_t size;
+};
+
+// Read-only view of a log written by `event_log`, possibly by another process.
+class event_log_reader {
+  unsigned char const* memory_;
+  std::size_t mapped_;
+  detail::log_header header_;
+
+public:
+  explicit event_log_reader(std::string const& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+      throw std::system_error{errno, std::generic_category(), "open " + path};
+    struct stat st;
+    if (::fstat(fd, &st) == -1) {
+      int error = errno;
+      ::close(fd);
+      throw std::system_error{error, std::generic_category(), "fstat " + path};
+    }
+    mapped_ = static_cast<std::size_t>(st.st_size);
+    if (mapped_ < sizeof(detail::log_header)) {
+      ::close(fd);
+      throw std::runtime_error{path + " is not an event log"};
+    }
+
+    void* memory = ::mmap(nullptr, mapped_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED)
+      throw std::system_error{errno, std::generic_category(), "mmap " + path};
+    memory_ = static_cast<unsigned char const*>(memory);
+
+    std::memcpy(&header_, memory_, sizeof(header_));
+    if (std::memcmp(header_.magic, detail::log_magic, sizeof(detail::log_magic)) != 0 ||
+        header_.version != 1 ||
+        header_.size > mapped_ - sizeof(detail::log_header)) {
+      ::munmap(const_cast<unsigned char*>(memory_), mapped_);
+      throw std::runtime_error{path + " is not an event log"};
+    }
+  }
+
+  event_log_reader(event_log_reader const&) = delete;
+  event_log_reader& operator=(event_log_reader const&) = delete;
+
+  ~event_log_reader() { ::munmap(const_cast<unsigned char*>(memory_), mapped_); }
+
+  std::uint64_t dropped() const { return header_.dropped; }
+
+  // Calls `f(record)` with each record of the log, in the order in which they
+  // were recorded. Throws `std::runtime_error` when reaching a record that
+  // does not fit in the log, after calling `f` with the records before it.
+  template <typename F>
+  void for_each(F f) const {
+    unsigned char const* in = memory_ + sizeof(detail::log_header);
+    unsigned char const* end = in + header_.size;
+    while (in != end) {
+      detail::record_header record;
+      std::size_t left = static_cast<std::size_t>(end - in);
+      if (left < sizeof(record))
+        throw std::runtime_error{"truncated record in event log"};
+      std::memcpy(&record, in, sizeof(record));
+      if (record.size > left - sizeof(record))
+        throw std::runtime_error{"truncated record in event log"};
+      in += sizeof(record);
+      f(event_record{record.event, record.timestamp, in, record.size});
+      in += record.size;
+    }
+  }
+};
+
+// Returns whether `path` starts like a log written by `event_log`.
+inline bool is_event_log(std::string const& path) {
+  char magic[sizeof(detail::log_magic)];
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+    return false;
+  bool matches = ::read(fd, magic, sizeof(magic)) == sizeof(magic) &&
+                 std::memcmp(magic, detail::log_magic, sizeof(magic)) == 0;
+  ::close(fd);
+  return matches;
+}
+
+#endif
@@ -0,0 +1,271 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef CODE_DYNO_FROM_SCRATCH_HPP
+#define CODE_DYNO_FROM_SCRATCH_HPP
+
+#include <boost/hana.hpp>
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <variant>
+namespace hana = boost::hana;
+
+
+// This is a minimal reimplementation of Dyno from scratch, to make sure
+// that what I present in my slides compiles more-or-less fine. I can't
+// just put the actual implementation of Dyno in slides because it would
+// be too convoluted.
+
+
+// sample(dsl)
+template <typename Signature>
+constexpr hana::basic_type<Signature> function{};
+
+struct self;
+
+// end-sample sample(dsl) sample(string)
+template <char ...c>
+struct string {
+  template <typename Signature>
+  constexpr auto operator=(Signature sig) const {
+    return hana::make_pair(*this, sig);
+  }
+};
+// end-sample sample(dsl)
+
+template <typename CharT, CharT ...c>
+constexpr string<c...> operator""_s() {
+  return {};
+}
+// end-sample
+
+struct string_tag;
+
+
+namespace boost { namespace hana {
+  template <char ...c>
+  struct tag_of<::string<c...>> {
+    using type = ::string_tag;
+  };
+
+  template <>
+  struct equal_impl<::string_tag, ::string_tag> {
+    template <typename X, typename Y>
+    static constexpr auto apply(X, Y) {
+      return std::is_same<X, Y>{};
+    }
+  };
+
+  template <>
+  struct hash_impl<::string_tag> {
+      template <typename String>
+      static constexpr auto apply(String const&) {
+          return hana::type_c<String>;
+      }
+  };
+}} // end namespace boost::hana
+
+// sample(trait)
+template <typename ...Methods>
+struct trait_t {
+  hana::tuple<Methods...> methods;
+};
+
+template <typename ...Methods>
+constexpr trait_t<Methods...> trait(Methods ...) {
+  return {};
+}
+// end-sample
+
+
+// sample(impl)
+template <typename ...Name, typename ...Method>
+auto make_impl(hana::pair<Name, Method> ...m) {
+  return hana::make_map(m...);
+}
+
+template <typename Trait, typename T>
+auto impl = make_impl();
+// end-sample
+
+
+namespace detail {
+  // Parameters of a method that refer to the erased object, which are passed
+  // to the erased function as pointers and turned back into references to
+  // the actual type by `self_ref`.
+  template <typename T> struct erase { using type = T; };
+  template <> struct erase<self const&> { using type = void const*; };
+  template <> struct erase<self&> { using type = void*; };
+
+  template <typename Pointer>
+  struct self_ref {
+    Pointer p;
+
+    template <typename T>
+    operator T&() const { return *static_cast<T*>(p); }
+  };
+
+  template <typename Original, typename Arg>
+  decltype(auto) unerase(Arg&& arg) {
+    if constexpr (std::is_same<std::decay_t<Original>, self>::value)
+      return self_ref<typename erase<Original>::type>{arg};
+    else
+      return std::forward<Arg>(arg);
+  }
+
+  // The implementations of a method are captureless lambdas, which are not
+  // default-constructible before C++20. Since they have no state, any
+  // suitably aligned storage can serve as one, which is what Dyno does too.
+  template <typename F>
+  F const& empty_object() {
+    static_assert(std::is_empty<F>::value,
+      "the implementation of a method can't have any state");
+    static typename std::aligned_storage<sizeof(F), alignof(F)>::type storage{};
+    return *reinterpret_cast<F const*>(&storage);
+  }
+
+  template <typename Signature, typename F>
+  struct erased_function;
+
+  template <typename R, typename ...Args, typename F>
+  struct erased_function<R(Args...), F> {
+    static R apply(typename erase<Args>::type ...args) {
+      return empty_object<F>()(unerase<Args>(args)...);
+    }
+  };
+}
+
+template <typename Signature>
+struct erase_signature;
+
+template <typename R, typename ...Args>
+struct erase_signature<R(Args...)> {
+  using type = R(typename detail::erase<Args>::type...);
+};
+
+template <typename Signature>
+using erase_signature_t = typename erase_signature<Signature>::type;
+
+// sample(vtable_layout)
+template <typename Trait>
+auto vtable_layout(Trait t) {
+  auto erased = hana::transform(t.methods,
+    hana::fuse([](auto name, auto sig) {
+      using Signature = typename decltype(sig)::type;
+
+      // 'double (T const&)' -> 'double (void const*)'
+      using Erased = erase_signature_t<Signature>;
+
+      return hana::type<hana::pair<decltype(name), Erased*>>{};
+    }));
+
+  // 'erased' is a 'tuple<type<pair<Name, Signature*>>...>'
+  // we return a 'type<map<pair<Name, Signature*>...>>'
+  return hana::unpack(erased, hana::template_<hana::map>);
+}
+// end-sample
+
+
+template <typename Signature, typename F>
+auto erase_function(F) {
+  return &detail::erased_function<Signature, F>::apply;
+}
+
+// sample(erase_impl)
+template <typename Trait, typename Impl>
+auto erase_impl(Trait t, Impl impl) {
+  auto erased = hana::transform(t.methods,
+    hana::fuse([&](auto name, auto sig) {
+      using Signature = typename decltype(sig)::type;
+      return hana::make_pair(
+        name, erase_function<Signature>(impl[name])
+      );
+    }));
+
+  // 'erased' is a 'tuple<pair<Name, Signature*>>'
+  return hana::to_map(erased);
+}
+// end-sample
+
+
+// sample(vtable)
+template <typename Trait>
+class vtable {
+  using Map = typename decltype(vtable_layout(Trait{}))::type;
+  Map map_;
+
+public:
+  template <typename Impl>
+  explicit vtable(Impl impl)
+    : map_{erase_impl(Trait{}, impl)}
+  { }
+
+  template <typename F>
+  auto operator[](F f) const {
+    return map_[f];
+  }
+};
+// end-sample
+
+
+// sample(poly)
+template <typename Trait>
+struct poly {
+  template <typename T>
+  poly(T t)
+    : self_{new T{t}}
+    , vtable_{impl<Trait, T>} // <= interesting stuff here
+  { }
+
+  template <typename F>
+  auto operator->*(F f) const {
+    return [=](auto ...args) {
+      return vtable_[f](self_, args...);
+    };
+  }
+
+private:
+  void* self_; // simplification
+  vtable<Trait> vtable_;
+};
+// end-sample
+
+
+// sample(closed_poly)
+// Same as `poly`, but for a closed set of types `Ts...` listed up front. The
+// object is stored inline along with the index of its type, and a method is
+// called by testing that index against each type in turn, which compilers
+// turn into a switch over the inlined implementations.
+template <typename Trait, typename ...Ts>
+struct closed_poly {
+  template <typename T>
+  closed_poly(T t)
+    : self_{t}
+  { }
+
+  template <typename F>
+  auto operator->*(F f) const {
+    return [this, f](auto ...args) {
+      return this->template dispatch<0>(f, args...);
+    };
+  }
+
+private:
+  template <std::size_t I, typename F, typename ...Args>
+  auto dispatch(F f, Args ...args) const {
+    using T = std::variant_alternative_t<I, std::variant<Ts...>>;
+    if constexpr (I + 1 < sizeof...(Ts)) {
+      if (self_.index() != I)
+        return dispatch<I + 1>(f, args...);
+    }
+    return impl<Trait, T>[f](*std::get_if<I>(&self_), args...);
+  }
+
+  std::variant<Ts...> self_;
+};
+// end-sample
+
+#endif
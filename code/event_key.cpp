@@ -0,0 +1,56 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#include "callbacks.hana.hpp"
+#include "event_key.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+namespace hana = boost::hana;
+using namespace hana::literals;
+
+
+int main() {
+  // sample(usage)
+  auto events = make_event_system("connection_established"_key,
+                                  "connection_lost"_key);
+  int established = 0, lost = 0;
+  events.on("connection_established"_key, [&] { ++established; });
+  events.on(EVENT_KEY("connection_lost"), [&] { ++lost; });
+
+  events.trigger("connection_established"_key);
+  events.trigger(std::string{"connection_lost"}); // looked up by hash
+  // end-sample
+  assert(established == 1 && lost == 1);
+
+  static_assert("connection_lost"_key == EVENT_KEY("connection_lost"), "");
+  static_assert("connection_lost"_key != "connection_established"_key, "");
+  static_assert(decltype("connection_lost"_key)::hash == detail::fnv1a("connection_lost"), "");
+
+  // The mangled name of a key does not grow with the name of the event.
+  char const* key = typeid("connection_established_and_authenticated"_key).name();
+  char const* string = typeid("connection_established_and_authenticated"_s).name();
+  assert(std::strlen(key) < 40);
+  assert(std::strlen(string) > 40 * 3);
+
+  // Keys and strings can be mixed in the same event system.
+  auto mixed = make_event_system("begin"_s, "end"_key);
+  std::string log;
+  mixed.on("begin"_s, [&] { log += '['; });
+  mixed.on("end"_key, [&] { log += ']'; });
+  mixed.trigger(std::string{"begin"});
+  mixed.trigger(std::string{"end"});
+  assert(log == "[]");
+
+  // Names that are not the hash of any key are unknown.
+  bool unknown = false;
+  try {
+    mixed.trigger(std::string{"middle"});
+  } catch (std::out_of_range const&) {
+    unknown = true;
+  }
+  assert(unknown && log == "[]");
+}
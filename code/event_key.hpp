@@ -0,0 +1,117 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#ifndef CODE_EVENT_KEY_HPP
+#define CODE_EVENT_KEY_HPP
+
+#include <boost/hana.hpp>
+
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+namespace hana = boost::hana;
+
+
+// Compile-time key of an event, which can be used instead of a `hana::string`
+// to name the events of an `event_system`.
+//
+// A `hana::string` encodes each of its characters in the mangled name of every
+// function it is a template argument of, so each `on` and `trigger` of each
+// event produces a symbol that is longer than the name of the event. Instead,
+// `event_key` only holds the 64 bits FNV-1a hash of the name, so its mangled
+// name has a fixed width. Event keys compare and hash like `hana::string`s,
+// and the runtime `trigger` of `event_system` looks them up by hash.
+//
+// Since the name itself is not kept, two names with the same hash are the
+// same key. An `event_system` checks at compile-time that the hashes of its
+// events are unique, which would catch such a collision.
+
+namespace detail {
+  constexpr std::uint64_t fnv1a(std::string_view s) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (char c : s) {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+}
+
+// sample(event_key)
+template <std::uint64_t Hash>
+struct event_key {
+  static constexpr std::uint64_t hash = Hash;
+};
+
+#define EVENT_KEY(name) event_key< ::detail::fnv1a(name)>{}
+
+// Like hana's `_s`, this is a GNU extension; `EVENT_KEY` is the portable way.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+template <typename CharT, CharT ...c>
+constexpr auto operator""_key() {
+  constexpr char name[] = {c..., '\0'};
+  return event_key<detail::fnv1a(std::string_view{name, sizeof...(c)})>{};
+}
+#pragma GCC diagnostic pop
+// end-sample
+
+template <std::uint64_t H1, std::uint64_t H2>
+constexpr auto operator==(event_key<H1>, event_key<H2>) {
+  return hana::bool_c<H1 == H2>;
+}
+
+template <std::uint64_t H1, std::uint64_t H2>
+constexpr auto operator!=(event_key<H1>, event_key<H2>) {
+  return hana::bool_c<H1 != H2>;
+}
+
+struct event_key_tag;
+
+namespace boost { namespace hana {
+  template <std::uint64_t Hash>
+  struct tag_of<::event_key<Hash>> {
+    using type = ::event_key_tag;
+  };
+
+  template <>
+  struct equal_impl<::event_key_tag, ::event_key_tag> {
+    template <typename X, typename Y>
+    static constexpr auto apply(X const&, Y const&) {
+      return hana::bool_c<std::is_same<X, Y>::value>;
+    }
+  };
+
+  template <>
+  struct hash_impl<::event_key_tag> {
+    template <typename Key>
+    static constexpr auto apply(Key const&) {
+      return hana::type_c<Key>;
+    }
+  };
+}} // end namespace boost::hana
+
+namespace detail {
+  // Hash of the name of an event, and the name itself when it is known.
+  template <char ...c>
+  constexpr std::uint64_t key_hash(hana::string<c...> s) {
+    return fnv1a(s.c_str());
+  }
+
+  template <std::uint64_t Hash>
+  constexpr std::uint64_t key_hash(event_key<Hash>) {
+    return Hash;
+  }
+
+  template <char ...c>
+  constexpr std::string_view key_name(hana::string<c...> s) {
+    return s.c_str();
+  }
+
+  template <std::uint64_t Hash>
+  constexpr std::string_view key_name(event_key<Hash>) {
+    return {};
+  }
+}
+
+#endif
@@ -0,0 +1,65 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "hana.dim.scaled.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <ratio>
+
+
+bool close(double a, double b) { return std::abs(a - b) < 1e-9 * std::abs(b); }
+
+#if 0
+// sample(usage)
+kilometres   d{3.6};
+milliseconds t{2400};
+auto v = d / t;               // quantity<velocity, kilo/milli>; no multiply
+quantity<velocity> v_si{v};   // single multiply by 1000000
+metres       m{d};            // 3600 metres
+seconds      s{hours{1}};     // 3600 seconds
+milliseconds x{d};            // Compiler error!
+// end-sample
+#endif
+
+int main() {
+  kilometres   d{3.6};
+  milliseconds t{2400};
+
+  // Scales are combined in the type, not applied to the value.
+  auto v = d / t;
+  using V = decltype(v);
+  static_assert(V::dimensions{} == velocity{});
+  static_assert(std::ratio_equal<V::scale, std::ratio<1000000>>{});
+  assert(static_cast<double>(v) == 3.6 / 2400);
+
+  quantity<velocity> v_si{v};
+  assert(close(static_cast<double>(v_si), 1500));
+
+  metres m{d};
+  assert(close(static_cast<double>(m), 3600));
+
+  seconds s{hours{1}};
+  assert(close(static_cast<double>(s), 3600));
+
+  // A chain of conversions through intermediate units does not accumulate
+  // anything in the type; converting straight to the target is one multiply.
+  millimetres mm = quantity_cast<std::milli>(quantity_cast<std::ratio<1>>(d));
+  assert(close(static_cast<double>(mm), 3600000));
+
+  // Same-scale casts are free.
+  constexpr kilometres same = quantity_cast<std::kilo>(kilometres{1.5});
+  static_assert(same.value_ == 1.5);
+
+  // Adding quantities picks the finest of both scales.
+  auto sum = kilometres{1} + metres{500};
+  static_assert(std::ratio_equal<decltype(sum)::scale, std::ratio<1>>{});
+  assert(close(static_cast<double>(sum), 1500));
+
+  // Scales compose through products, too.
+  grams g{500};
+  quantity<acceleration, std::micro> a{9800000}; // in µm/s^2
+  quantity<force> f{g * a};
+  assert(close(static_cast<double>(f), 500 * 9.8 * 1e-3));
+}
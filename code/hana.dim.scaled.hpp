@@ -0,0 +1,142 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef CODE_HANA_DIM_SCALED_HPP
+#define CODE_HANA_DIM_SCALED_HPP
+
+#include <boost/hana/equal.hpp>
+#include <boost/hana/minus.hpp>
+#include <boost/hana/plus.hpp>
+#include <boost/hana/tuple.hpp>
+#include <boost/hana/zip_with.hpp>
+
+#include <functional>
+#include <ratio>
+#include <type_traits>
+namespace hana = boost::hana;
+
+
+// This is the same thing as `hana.dim.cpp`, except quantities also carry a
+// compile-time scale relative to the SI unit of their dimensions. Scales are
+// combined at compile-time when quantities are multiplied or divided, so the
+// only runtime cost of mixing units is a single multiplication by a constant
+// when a value is finally converted to the unit it is needed in.
+
+// base dimensions                              M  L  T  I  K  J  N
+using mass        = decltype(hana::tuple_c<int, 1, 0, 0, 0, 0, 0, 0>);
+using length      = decltype(hana::tuple_c<int, 0, 1, 0, 0, 0, 0, 0>);
+using time_       = decltype(hana::tuple_c<int, 0, 0, 1, 0, 0, 0, 0>);
+using charge      = decltype(hana::tuple_c<int, 0, 0, 0, 1, 0, 0, 0>);
+using temperature = decltype(hana::tuple_c<int, 0, 0, 0, 0, 1, 0, 0>);
+using intensity   = decltype(hana::tuple_c<int, 0, 0, 0, 0, 0, 1, 0>);
+using amount      = decltype(hana::tuple_c<int, 0, 0, 0, 0, 0, 0, 1>);
+
+// composite dimensions
+using velocity     = decltype(hana::tuple_c<int, 0, 1, -1, 0, 0, 0, 0>); // L/T
+using acceleration = decltype(hana::tuple_c<int, 0, 1, -2, 0, 0, 0, 0>); // L/T^2
+using force        = decltype(hana::tuple_c<int, 1, 1, -2, 0, 0, 0, 0>); // ML/T^2
+
+
+namespace detail {
+  // Factor by which a value expressed in `From` units must be multiplied to
+  // be expressed in `To` units. This is always a compile-time constant.
+  template <typename From, typename To>
+  constexpr double conversion_factor() {
+    using R = std::ratio_divide<From, To>;
+    return static_cast<double>(R::num) / static_cast<double>(R::den);
+  }
+
+  constexpr std::intmax_t gcd(std::intmax_t a, std::intmax_t b) {
+    return b == 0 ? a : gcd(b, a % b);
+  }
+
+  // Finest scale in which both `S1` and `S2` can be represented exactly,
+  // just like `std::common_type` for `std::chrono::duration`.
+  template <typename S1, typename S2>
+  using common_scale = std::ratio<
+    gcd(S1::num, S2::num),
+    (S1::den / gcd(S1::den, S2::den)) * S2::den
+  >;
+}
+
+// sample(quantity)
+template <typename Dimensions, typename Scale = std::ratio<1>>
+struct quantity {
+  using dimensions = Dimensions;
+  using scale = Scale;
+  double value_;
+  explicit constexpr quantity(double v) : value_(v) { }
+
+  template <typename OtherDimensions, typename OtherScale>
+  explicit constexpr quantity(quantity<OtherDimensions, OtherScale> other)
+    : value_(other.value_ * detail::conversion_factor<OtherScale, Scale>())
+  {
+    static_assert(Dimensions{} == OtherDimensions{},
+      "Constructing quantities with incompatible dimensions!");
+  }
+
+  explicit constexpr operator double() const { return value_; }
+};
+// end-sample
+
+// sample(quantity_cast)
+// Converts a quantity to another scale without changing its dimensions.
+// When `To` is the same as the current scale, no multiplication happens.
+template <typename To, typename D, typename From>
+constexpr quantity<D, To> quantity_cast(quantity<D, From> q) {
+  if constexpr (std::ratio_equal<From, To>::value)
+    return quantity<D, To>{q.value_};
+  else
+    return quantity<D, To>{q};
+}
+// end-sample
+
+// sample(dimensions-compose)
+// Scales are composed at compile-time; the runtime value is left untouched.
+template <typename D1, typename S1, typename D2, typename S2>
+constexpr auto operator*(quantity<D1, S1> a, quantity<D2, S2> b) {
+  using D = decltype(hana::zip_with(std::plus<>{}, D1{}, D2{}));
+  using S = std::ratio_multiply<S1, S2>;
+  return quantity<D, S>{static_cast<double>(a) * static_cast<double>(b)};
+}
+
+template <typename D1, typename S1, typename D2, typename S2>
+constexpr auto operator/(quantity<D1, S1> a, quantity<D2, S2> b) {
+  using D = decltype(hana::zip_with(std::minus<>{}, D1{}, D2{}));
+  using S = std::ratio_divide<S1, S2>;
+  return quantity<D, S>{static_cast<double>(a) / static_cast<double>(b)};
+}
+// end-sample
+
+template <typename D1, typename S1, typename D2, typename S2>
+constexpr auto operator+(quantity<D1, S1> a, quantity<D2, S2> b) {
+  static_assert(D1{} == D2{},
+    "Adding quantities with incompatible dimensions!");
+  using S = detail::common_scale<S1, S2>;
+  return quantity<D1, S>{quantity_cast<S>(a).value_ +
+                         quantity_cast<S>(quantity<D1, S2>{b.value_}).value_};
+}
+
+template <typename D1, typename S1, typename D2, typename S2>
+constexpr auto operator-(quantity<D1, S1> a, quantity<D2, S2> b) {
+  static_assert(D1{} == D2{},
+    "Subtracting quantities with incompatible dimensions!");
+  using S = detail::common_scale<S1, S2>;
+  return quantity<D1, S>{quantity_cast<S>(a).value_ -
+                         quantity_cast<S>(quantity<D1, S2>{b.value_}).value_};
+}
+
+
+// sample(units)
+using kilograms    = quantity<mass>;
+using grams        = quantity<mass, std::milli>;
+using metres       = quantity<length>;
+using kilometres   = quantity<length, std::kilo>;
+using millimetres  = quantity<length, std::milli>;
+using seconds      = quantity<time_>;
+using milliseconds = quantity<time_, std::milli>;
+using hours        = quantity<time_, std::ratio<3600>>;
+// end-sample
+
+#endif
@@ -0,0 +1,55 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#include "json_delta.hpp"
+#include "to_json.hpp"
+
+#include <boost/hana.hpp>
+
+#include <cassert>
+#include <string>
+#include <vector>
+namespace hana = boost::hana;
+
+
+struct Position {
+  BOOST_HANA_DEFINE_STRUCT(Position,
+    (double, x),
+    (double, y)
+  );
+};
+
+struct Vehicle {
+  BOOST_HANA_DEFINE_STRUCT(Vehicle,
+    (std::string, name),
+    (Position, position),
+    (int, speed),
+    (std::vector<std::string>, passengers)
+  );
+};
+
+int main() {
+  Vehicle car{"Z3", {0.0, 0.0}, 0, {"Louis"}};
+
+  // sample(usage)
+  json_delta_writer<Vehicle> writer;
+  std::string first = writer.patch(car);  // everything
+
+  car.speed = 50;
+  car.position.x = 1.5;
+  std::string patch = writer.patch(car);  // only `position` and `speed`
+  std::string full = writer.full(car);    // spliced from cached fragments
+  // end-sample
+
+  assert(first == to_json(Vehicle{"Z3", {0.0, 0.0}, 0, {"Louis"}}));
+  assert(patch == "{\"position\" : {\"x\" : 1.500000, \"y\" : 0.000000}, \"speed\" : 50}");
+  assert(full == to_json(car));
+
+  // Nothing changed since the last call.
+  assert(writer.patch(car) == "{}");
+  assert(writer.full(car) == to_json(car));
+
+  car.passengers.push_back("Rebecca");
+  assert(writer.patch(car) == "{\"passengers\" : [\"Louis\", \"Rebecca\"]}");
+  assert(writer.full(car) == to_json(car));
+}
@@ -0,0 +1,91 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#ifndef CODE_JSON_DELTA_HPP
+#define CODE_JSON_DELTA_HPP
+
+#include "struct_ops.hpp"
+#include "to_json.hpp"
+
+#include <boost/hana.hpp>
+
+#include <array>
+#include <cstddef>
+#include <string>
+namespace hana = boost::hana;
+
+
+// Serialization of successive states of the same `hana::Struct` to JSON, at
+// a cost proportional to what changed between two states.
+//
+// The writer keeps the last state it was given, and the `"name" : value`
+// fragment of each of its members. On each call, members are compared with
+// the last state (using the operators of `struct_ops.hpp` for nested
+// Structs), and only the changed ones are serialized again. `patch` then
+// returns a JSON merge patch (RFC 7396) holding the changed members, and
+// `full` returns the whole document spliced from the cached fragments.
+
+template <typename T>
+class json_delta_writer {
+  static constexpr std::size_t N = decltype(hana::length(hana::accessors<T>()))::value;
+
+  T last_{};
+  std::array<std::string, N> fragments_;
+  std::array<bool, N> changed_{};
+  bool primed_ = false;
+
+  // Updates the last state and the fragments of the members that changed.
+  void update(T const& x) {
+    std::size_t i = 0;
+    hana::for_each(hana::accessors<T>(), [&](auto accessor) {
+      auto const& member = hana::second(accessor)(x);
+      auto& last = hana::second(accessor)(last_);
+      changed_[i] = !primed_ || !(last == member);
+      if (changed_[i]) {
+        fragments_[i] = quote(hana::to<char const*>(hana::first(accessor))) + " : " + to_json(member);
+        last = member;
+      }
+      ++i;
+    });
+    primed_ = true;
+  }
+
+  template <typename Pred>
+  std::string splice(Pred pred) const {
+    std::size_t size = 2;
+    for (std::size_t i = 0; i != N; ++i)
+      if (pred(i))
+        size += fragments_[i].size() + 2;
+
+    std::string json;
+    json.reserve(size);
+    json += '{';
+    bool first = true;
+    for (std::size_t i = 0; i != N; ++i) {
+      if (!pred(i))
+        continue;
+      if (!first)
+        json += ", ";
+      json += fragments_[i];
+      first = false;
+    }
+    json += '}';
+    return json;
+  }
+
+public:
+  // Returns the members of `x` that changed since the last call, as a JSON
+  // object. The first call returns all the members.
+  std::string patch(T const& x) {
+    update(x);
+    return splice([this](std::size_t i) { return changed_[i]; });
+  }
+
+  // Returns the JSON document of `x`, which is the same as `to_json(x)`.
+  std::string full(T const& x) {
+    update(x);
+    return splice([](std::size_t) { return true; });
+  }
+};
+
+#endif
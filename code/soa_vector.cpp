@@ -0,0 +1,110 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#define BOOST_HANA_CONFIG_ENABLE_STRING_UDL
+#include "soa_vector.hpp"
+#include "to_json.hpp"
+
+#include <boost/hana.hpp>
+
+#include <cassert>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+namespace hana = boost::hana;
+using namespace hana::literals;
+
+
+struct Car {
+  BOOST_HANA_DEFINE_STRUCT(Car,
+    (std::string, brand),
+    (std::string, model),
+    (int, year),
+    (double, price)
+  );
+};
+
+// A member whose copy throws for negative values.
+struct Checked {
+  int value;
+  Checked(int v) : value(v) { }
+  Checked(Checked const& other) : value(other.value) {
+    if (value < 0)
+      throw std::invalid_argument{"negative"};
+  }
+  Checked& operator=(Checked const&) = default;
+};
+
+struct Reading {
+  BOOST_HANA_DEFINE_STRUCT(Reading,
+    (int, sensor),
+    (Checked, value)
+  );
+};
+
+int main() {
+  // sample(usage)
+  std::vector<Car> cars = {
+    {"BMW", "Z3", 1995, 30000.},
+    {"Audi", "A4", 2004, 25000.},
+    {"Ferrari", "F40", 1987, 400000.}
+  };
+
+  soa_vector<Car> soa(cars.begin(), cars.end());
+  soa.push_back({"Lamborghini", "Diablo", 1990, 250000.});
+
+  // Scanning a column only reads the prices.
+  auto const& prices = soa.column("price"_s);
+  double total = std::accumulate(prices.begin(), prices.end(), 0.0);
+
+  // Elements are proxies with the same members as Car.
+  soa[1]["model"_s] = "A6";
+  Car audi = soa[1];
+  // end-sample
+
+  assert(soa.size() == 4);
+  assert(total == 30000. + 25000. + 400000. + 250000.);
+  assert(audi.brand == "Audi" && audi.model == "A6" && audi.year == 2004);
+  assert(soa.column("model"_s)[3] == "Diablo");
+
+  // Proxies are hana::Structs, so generic code like to_json works on them,
+  // and the container prints exactly like a std::vector<Car>.
+  cars[1].model = "A6";
+  cars.push_back({"Lamborghini", "Diablo", 1990, 250000.});
+  assert(to_json(soa[0]) == to_json(cars[0]));
+  assert(to_json(soa) == to_json(cars));
+
+  // Assigning through a proxy assigns the members of the element.
+  soa[0] = soa[3];
+  assert(static_cast<Car>(soa[0]).model == "Diablo");
+  assert(soa.column("brand"_s)[3] == "Lamborghini");
+
+  soa_vector<Car> const& csoa = soa;
+  int years = 0;
+  for (auto car : csoa)
+    years += car["year"_s];
+  assert(years == 1990 + 2004 + 1987 + 1990);
+
+  // Input iterators, like the ones of soa_vector itself, are walked once.
+  soa_vector<Car> copy(soa.begin(), soa.end());
+  assert(to_json(copy) == to_json(soa));
+
+  // A member that fails to copy leaves all the columns with the same length.
+  soa_vector<Reading> readings;
+  readings.push_back(Reading{1, 10});
+  bool thrown = false;
+  try { readings.push_back(Reading{2, -1}); } catch (std::invalid_argument const&) { thrown = true; }
+  assert(thrown && readings.size() == 1);
+  assert(readings.column("sensor"_s).size() == 1 && readings.column("value"_s).size() == 1);
+
+  std::vector<Reading> batch = {Reading{3, 30}, Reading{4, 40}};
+  batch[1].value.value = -1;
+  thrown = false;
+  try { readings.append(batch.begin(), batch.end()); } catch (std::invalid_argument const&) { thrown = true; }
+  assert(thrown && readings.size() == 1);
+  assert(readings.column("sensor"_s).size() == 1 && readings.column("value"_s).size() == 1);
+
+  soa.clear();
+  assert(soa.empty() && soa.column("price"_s).empty());
+}
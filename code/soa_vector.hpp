@@ -0,0 +1,237 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#ifndef CODE_SOA_VECTOR_HPP
+#define CODE_SOA_VECTOR_HPP
+
+#include <boost/hana.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+namespace hana = boost::hana;
+
+
+// Sequence of `hana::Struct`s stored as a struct of arrays: each member of
+// `T` lives in its own contiguous column, so a scan over a few members of
+// many records only brings those members into the cache.
+//
+// The columns are generated from `hana::accessors<T>()`. Elements are accessed
+// through proxies which are themselves `hana::Struct`s with the members of
+// `T`, so generic code written against the Struct concept, like `to_json`,
+// works with them unchanged. `T` must be default constructible to be copied
+// out of the container.
+
+template <typename T>
+class soa_vector;
+
+namespace detail {
+  template <typename T>
+  auto make_columns() {
+    return hana::unpack(hana::accessors<T>(), [](auto ...member) {
+      return hana::make_map(hana::make_pair(
+        hana::first(member),
+        std::vector<std::decay_t<decltype(hana::second(member)(std::declval<T&>()))>>{}
+      )...);
+    });
+  }
+
+  template <typename T>
+  using columns = decltype(make_columns<T>());
+}
+
+// sample(reference)
+// Proxy to the `i`-th element of a `soa_vector`, with the same members as `T`.
+// `r["model"_s]` is a reference to the `model` of that element.
+template <typename T, bool IsConst>
+class soa_reference {
+  using Vector = std::conditional_t<IsConst, soa_vector<T> const, soa_vector<T>>;
+  Vector* v_;
+  std::size_t i_;
+
+public:
+  soa_reference(Vector& v, std::size_t i) : v_(&v), i_(i) { }
+
+  template <typename Name>
+  decltype(auto) operator[](Name name) const {
+    return v_->column(name)[i_];
+  }
+// end-sample
+
+  operator T() const {
+    T x;
+    hana::for_each(hana::accessors<T>(), [&](auto member) {
+      hana::second(member)(x) = (*this)[hana::first(member)];
+    });
+    return x;
+  }
+
+  // Assigning through a proxy assigns the members of the element, like
+  // assigning through a `T&` would.
+  soa_reference& operator=(T const& x) {
+    static_assert(!IsConst, "trying to assign through a const soa_vector reference");
+    hana::for_each(hana::accessors<T>(), [&](auto member) {
+      (*this)[hana::first(member)] = hana::second(member)(x);
+    });
+    return *this;
+  }
+
+  soa_reference& operator=(soa_reference const& other) {
+    return *this = static_cast<T>(other);
+  }
+
+  soa_reference(soa_reference const&) = default;
+
+  struct hana_accessors_impl {
+    static auto apply() {
+      return hana::transform(hana::accessors<T>(), [](auto member) {
+        using Name = std::decay_t<decltype(hana::first(member))>;
+        return hana::make_pair(Name{}, [](auto&& ref) -> decltype(auto) {
+          return ref[Name{}];
+        });
+      });
+    }
+  };
+};
+
+template <typename T, bool IsConst>
+class soa_iterator {
+  using Vector = std::conditional_t<IsConst, soa_vector<T> const, soa_vector<T>>;
+  Vector* v_;
+  std::size_t i_;
+
+public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = T;
+  using difference_type = std::ptrdiff_t;
+  using reference = soa_reference<T, IsConst>;
+  using pointer = void;
+
+  soa_iterator(Vector& v, std::size_t i) : v_(&v), i_(i) { }
+
+  reference operator*() const { return {*v_, i_}; }
+  soa_iterator& operator++() { ++i_; return *this; }
+  soa_iterator operator++(int) { auto old = *this; ++i_; return old; }
+
+  friend bool operator==(soa_iterator const& a, soa_iterator const& b) { return a.i_ == b.i_; }
+  friend bool operator!=(soa_iterator const& a, soa_iterator const& b) { return a.i_ != b.i_; }
+};
+
+// sample(soa_vector)
+template <typename T>
+class soa_vector {
+  static_assert(hana::Struct<T>::value,
+    "soa_vector<T> requires T to be a hana::Struct");
+
+  detail::columns<T> columns_;
+  std::size_t size_ = 0;
+// end-sample
+
+public:
+  using value_type = T;
+  using reference = soa_reference<T, false>;
+  using const_reference = soa_reference<T, true>;
+  using iterator = soa_iterator<T, false>;
+  using const_iterator = soa_iterator<T, true>;
+  using size_type = std::size_t;
+
+  soa_vector() = default;
+
+  template <typename Iterator, typename = typename std::iterator_traits<Iterator>::iterator_category>
+  soa_vector(Iterator first, Iterator last) { append(first, last); }
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+// sample(column)
+  // The contiguous column holding the member called `name` of every element.
+  template <typename Name>
+  auto& column(Name name) { return columns_[name]; }
+
+  template <typename Name>
+  auto const& column(Name name) const { return columns_[name]; }
+// end-sample
+
+  reference operator[](std::size_t i) { return {*this, i}; }
+  const_reference operator[](std::size_t i) const { return {*this, i}; }
+
+  iterator begin() { return {*this, 0}; }
+  iterator end() { return {*this, size_}; }
+  const_iterator begin() const { return {*this, 0}; }
+  const_iterator end() const { return {*this, size_}; }
+
+  void reserve(std::size_t n) {
+    hana::for_each(hana::keys(columns_), [&](auto name) { columns_[name].reserve(n); });
+  }
+
+  void clear() {
+    hana::for_each(hana::keys(columns_), [&](auto name) { columns_[name].clear(); });
+    size_ = 0;
+  }
+
+  // If copying or moving a member throws, the members of `x` already added
+  // are removed, so that all the columns keep the same length.
+  void push_back(T const& x) {
+    try {
+      hana::for_each(hana::accessors<T>(), [&](auto member) {
+        columns_[hana::first(member)].push_back(hana::second(member)(x));
+      });
+    } catch (...) {
+      truncate(size_);
+      throw;
+    }
+    ++size_;
+  }
+
+  void push_back(T&& x) {
+    try {
+      hana::for_each(hana::accessors<T>(), [&](auto member) {
+        columns_[hana::first(member)].push_back(std::move(hana::second(member)(x)));
+      });
+    } catch (...) {
+      truncate(size_);
+      throw;
+    }
+    ++size_;
+  }
+
+// sample(append)
+  // Appends the elements of `[first, last)`, filling one column at a time so
+  // that each column is written sequentially. Input iterators can only be
+  // walked once, so their elements are appended one after the other instead.
+  template <typename Iterator, typename Category = typename std::iterator_traits<Iterator>::iterator_category>
+  void append(Iterator first, Iterator last) {
+    if constexpr (std::is_base_of<std::forward_iterator_tag, Category>::value) {
+      std::size_t n = std::distance(first, last);
+      reserve(size_ + n);
+      try {
+        hana::for_each(hana::accessors<T>(), [&](auto member) {
+          auto& column = columns_[hana::first(member)];
+          for (auto it = first; it != last; ++it)
+            column.push_back(hana::second(member)(*it));
+        });
+      } catch (...) {
+        truncate(size_);
+        throw;
+      }
+      size_ += n;
+    } else {
+      for (; first != last; ++first)
+        push_back(*first);
+    }
+  }
+// end-sample
+
+private:
+  // Removes the elements past the first `n` of each column.
+  void truncate(std::size_t n) {
+    hana::for_each(hana::keys(columns_), [&](auto name) {
+      auto& column = columns_[name];
+      column.erase(column.begin() + n, column.end());
+    });
+  }
+};
+
+#endif
@@ -0,0 +1,120 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#include "struct_ops.hpp"
+
+#include <boost/hana.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+namespace hana = boost::hana;
+
+
+struct Car {
+  BOOST_HANA_DEFINE_STRUCT(Car,
+    (std::string, brand),
+    (std::string, model)
+  );
+};
+
+// The first four members are compared with a single memcmp and hashed as
+// one 24 bytes span; `price` and `symbol` are handled one by one.
+struct Trade {
+  BOOST_HANA_DEFINE_STRUCT(Trade,
+    (std::uint64_t, id),
+    (std::uint32_t, venue),
+    (std::uint32_t, side),
+    (std::int64_t, quantity),
+    (double, price),
+    (std::string, symbol)
+  );
+};
+
+struct Fleet {
+  BOOST_HANA_DEFINE_STRUCT(Fleet,
+    (Car, flagship),
+    (int, size)
+  );
+};
+
+struct Route {
+  BOOST_HANA_DEFINE_STRUCT(Route,
+    (std::string, name),
+    (std::vector<int>, stops),
+    (std::vector<Car>, cars)
+  );
+};
+
+int main() {
+  // sample(usage)
+  std::unordered_set<Car, struct_hash> cars = {
+    {"BMW", "Z3"}, {"Audi", "A4"}, {"BMW", "Z3"}
+  };
+  std::set<Car> sorted(cars.begin(), cars.end());
+  // end-sample
+
+  assert(cars.size() == 2);
+  assert(sorted.size() == 2);
+  assert(sorted.begin()->brand == "Audi");
+  assert((Car{"BMW", "Z3"} == Car{"BMW", "Z3"}));
+  assert((Car{"BMW", "Z3"} != Car{"BMW", "Z4"}));
+  assert((Car{"BMW", "Z3"} < Car{"BMW", "Z4"}));
+  assert(!(Car{"BMW", "Z4"} < Car{"BMW", "Z3"}));
+
+  using M = detail::members<Trade>;
+  static_assert(M::run_end(0) == 4, "");
+  static_assert(!M::bitwise[4] && !M::bitwise[5], "");
+
+  Trade a{1, 2, 3, 100, 10.5, "ACME"};
+  Trade b = a;
+  assert(a == b);
+  assert(hash_value(a) == hash_value(b));
+  b.side = 4;
+  assert(a != b);
+  assert(a < b);
+  b = a;
+  b.price = 11.0;
+  assert(a != b && a < b);
+  b = a;
+  b.symbol = "ACMF";
+  assert(a != b && a < b);
+
+  // Ordering is by value, not by the bytes of the members.
+  Trade low{256, 0, 0, 0, 0, ""}, high{1, 0, 0, 0, 0, ""};
+  assert(high < low);
+
+  // Floating-point members are compared by value.
+  Trade zero{1, 2, 3, 4, 0.0, "X"}, negative_zero{1, 2, 3, 4, -0.0, "X"};
+  assert(zero == negative_zero);
+  assert(hash_value(zero) == hash_value(negative_zero));
+
+  // Nested Structs use the generated operations too.
+  Fleet f1{{"BMW", "Z3"}, 3}, f2{{"BMW", "Z3"}, 3};
+  assert(f1 == f2 && hash_value(f1) == hash_value(f2));
+  f2.flagship.model = "Z4";
+  assert(f1 != f2 && f1 < f2);
+
+  // Members that are ranges are hashed element by element.
+  Route r1{"Z3", {1, 2, 3}, {{"BMW", "Z3"}}}, r2 = r1;
+  assert(r1 == r2 && hash_value(r1) == hash_value(r2));
+  r2.stops.push_back(4);
+  assert(r1 != r2 && hash_value(r1) != hash_value(r2));
+  r2 = r1;
+  r2.cars[0].model = "Z4";
+  assert(r1 != r2 && hash_value(r1) != hash_value(r2));
+
+  // Hashes spread over the buckets.
+  std::unordered_set<Trade, struct_hash> trades;
+  for (std::uint64_t i = 0; i != 10000; ++i)
+    trades.insert(Trade{i % 5000, 1, 1, 1, 1.0, "ACME"});
+  assert(trades.size() == 5000);
+  std::size_t largest = 0;
+  for (std::size_t bucket = 0; bucket != trades.bucket_count(); ++bucket)
+    largest = std::max(largest, trades.bucket_size(bucket));
+  assert(largest < 10);
+}
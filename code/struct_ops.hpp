@@ -0,0 +1,252 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#ifndef CODE_STRUCT_OPS_HPP
+#define CODE_STRUCT_OPS_HPP
+
+#include <boost/hana.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+namespace hana = boost::hana;
+
+
+// Equality, ordering and hashing generated for any `hana::Struct`, so they
+// never go out of sync with the members of the type.
+//
+// Consecutive members whose values are exactly their bytes (integers, enums,
+// pointers, and aggregates of those without padding, as told by
+// `std::has_unique_object_representations`) are compared with a single
+// `memcmp` and hashed a word at a time, as long as the compiler laid them out
+// without padding in between. Other members, like strings and floating-point
+// numbers, are compared and hashed one by one. Ordering is always member by
+// member, since `memcmp` does not order multi-byte integers by value.
+//
+// The operators are found by unqualified lookup, so types declared in another
+// namespace must bring them in with `using ::operator==;` and friends.
+
+namespace detail {
+  template <typename T>
+  constexpr bool is_bitwise = std::has_unique_object_representations<T>::value;
+
+  inline std::uint64_t mix(std::uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+  }
+
+  inline std::size_t hash_combine(std::size_t seed, std::size_t h) {
+    return mix(seed ^ (h + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2)));
+  }
+
+  // Hashes `n` bytes a 64 bits word at a time.
+  inline std::size_t hash_bytes(unsigned char const* p, std::size_t n, std::size_t seed) {
+    std::uint64_t h = seed ^ (n * 0x9e3779b97f4a7c15ull);
+    for (; n >= sizeof(std::uint64_t); p += sizeof(std::uint64_t), n -= sizeof(std::uint64_t)) {
+      std::uint64_t w;
+      std::memcpy(&w, p, sizeof(w));
+      h = (h ^ mix(w)) * 0x9e3779b97f4a7c15ull;
+    }
+    if (n != 0) {
+      std::uint64_t w = 0;
+      std::memcpy(&w, p, n);
+      h = (h ^ mix(w)) * 0x9e3779b97f4a7c15ull;
+    }
+    return mix(h);
+  }
+
+  template <typename T, typename Indices = std::make_index_sequence<
+    decltype(hana::length(hana::accessors<T>()))::value
+  >>
+  struct members;
+
+  template <typename T, std::size_t ...i>
+  struct members<T, std::index_sequence<i...>> {
+    static constexpr std::size_t count = sizeof...(i);
+
+    template <std::size_t k>
+    static decltype(auto) get(T const& x) {
+      return hana::second(hana::at_c<k>(hana::accessors<T>()))(x);
+    }
+
+    template <std::size_t k>
+    using type = std::decay_t<decltype(get<k>(std::declval<T const&>()))>;
+
+    static constexpr bool bitwise[] = {is_bitwise<type<i>>..., false};
+    static constexpr std::size_t sizes[] = {sizeof(type<i>)..., 0};
+
+    // End of the run of bitwise members starting at `k`.
+    static constexpr std::size_t run_end(std::size_t k) {
+      while (k != count && bitwise[k]) ++k;
+      return k;
+    }
+
+    static constexpr std::size_t run_size(std::size_t first, std::size_t last) {
+      std::size_t size = 0;
+      for (; first != last; ++first)
+        size += sizes[first];
+      return size;
+    }
+
+    // Whether the members in `[first, last)` of `x` are laid out back to
+    // back. This only depends on the type, so it folds to a constant.
+    template <std::size_t first, std::size_t last>
+    static bool contiguous(T const& x) {
+      auto begin = reinterpret_cast<unsigned char const*>(&get<first>(x));
+      auto end = reinterpret_cast<unsigned char const*>(&get<last - 1>(x)) + sizes[last - 1];
+      return static_cast<std::size_t>(end - begin) == run_size(first, last);
+    }
+  };
+
+  template <typename T, typename = void>
+  struct is_std_hashable : std::false_type { };
+
+  template <typename T>
+  struct is_std_hashable<T, std::void_t<
+    decltype(std::hash<T>{}(std::declval<T const&>()))
+  >> : std::true_type { };
+
+  template <typename T, typename = void>
+  struct is_range : std::false_type { };
+
+  template <typename T>
+  struct is_range<T, std::void_t<
+    decltype(std::begin(std::declval<T const&>()) != std::end(std::declval<T const&>()))
+  >> : std::true_type { };
+
+  // Whether `T` stores bitwise elements contiguously, like `std::vector<int>`.
+  template <typename T, typename = void>
+  struct is_bitwise_span : std::false_type { };
+
+  template <typename T>
+  struct is_bitwise_span<T, std::void_t<
+    decltype(std::size(std::declval<T const&>())),
+    std::enable_if_t<is_bitwise<std::remove_cv_t<std::remove_pointer_t<
+      decltype(std::data(std::declval<T const&>()))
+    >>>>
+  >> : std::true_type { };
+
+  // Members that are ranges, like `std::vector`s, are hashed element by
+  // element, or as a single span of bytes when the elements are bitwise and
+  // stored contiguously.
+  template <typename T>
+  std::size_t hash_member(T const& x, std::size_t seed);
+
+  template <typename T, std::size_t k = 0>
+  bool equal_from(T const& a, T const& b) {
+    using M = members<T>;
+    if constexpr (k == M::count) {
+      return true;
+    } else if constexpr (!M::bitwise[k]) {
+      return M::template get<k>(a) == M::template get<k>(b) && equal_from<T, k + 1>(a, b);
+    } else {
+      constexpr std::size_t last = M::run_end(k);
+      if (M::template contiguous<k, last>(a)) {
+        if (std::memcmp(&M::template get<k>(a), &M::template get<k>(b), M::run_size(k, last)) != 0)
+          return false;
+        return equal_from<T, last>(a, b);
+      }
+      return M::template get<k>(a) == M::template get<k>(b) && equal_from<T, k + 1>(a, b);
+    }
+  }
+
+  template <typename T, std::size_t k = 0>
+  bool less_from(T const& a, T const& b) {
+    using M = members<T>;
+    if constexpr (k == M::count) {
+      return false;
+    } else {
+      auto const& x = M::template get<k>(a);
+      auto const& y = M::template get<k>(b);
+      if (x < y) return true;
+      if (y < x) return false;
+      return less_from<T, k + 1>(a, b);
+    }
+  }
+
+  template <typename T, std::size_t k = 0>
+  std::size_t hash_from(T const& x, std::size_t seed) {
+    using M = members<T>;
+    if constexpr (k == M::count) {
+      return seed;
+    } else if constexpr (!M::bitwise[k]) {
+      return hash_from<T, k + 1>(x, hash_member(M::template get<k>(x), seed));
+    } else {
+      constexpr std::size_t last = M::run_end(k);
+      if (M::template contiguous<k, last>(x)) {
+        auto bytes = reinterpret_cast<unsigned char const*>(&M::template get<k>(x));
+        return hash_from<T, last>(x, hash_bytes(bytes, M::run_size(k, last), seed));
+      }
+      return hash_from<T, k + 1>(x, hash_member(M::template get<k>(x), seed));
+    }
+  }
+
+  template <typename T>
+  std::size_t hash_member(T const& x, std::size_t seed) {
+    if constexpr (hana::Struct<T>::value) {
+      return hash_from(x, seed);
+    } else if constexpr (is_bitwise<T>) {
+      return hash_bytes(reinterpret_cast<unsigned char const*>(&x), sizeof(T), seed);
+    } else if constexpr (is_std_hashable<T>::value) {
+      return hash_combine(seed, std::hash<T>{}(x));
+    } else if constexpr (is_bitwise_span<T>::value) {
+      return hash_bytes(reinterpret_cast<unsigned char const*>(std::data(x)),
+                        std::size(x) * sizeof(*std::data(x)), seed);
+    } else if constexpr (is_range<T>::value) {
+      std::size_t n = 0;
+      for (auto const& element : x) {
+        seed = hash_member(element, seed);
+        ++n;
+      }
+      return hash_combine(seed, n);
+    } else {
+      static_assert(is_range<T>::value,
+        "trying to hash a member that is neither a hana::Struct, a range, "
+        "a type made only of its bytes, nor a type with a std::hash specialization");
+      return seed;
+    }
+  }
+}
+
+// sample(operators)
+template <typename T>
+  std::enable_if_t<hana::Struct<T>::value,
+bool> operator==(T const& a, T const& b) {
+  return detail::equal_from(a, b);
+}
+
+template <typename T>
+  std::enable_if_t<hana::Struct<T>::value,
+bool> operator!=(T const& a, T const& b) {
+  return !(a == b);
+}
+
+template <typename T>
+  std::enable_if_t<hana::Struct<T>::value,
+bool> operator<(T const& a, T const& b) {
+  return detail::less_from(a, b);
+}
+
+template <typename T>
+  std::enable_if_t<hana::Struct<T>::value,
+std::size_t> hash_value(T const& x) {
+  return detail::hash_from(x, 0);
+}
+
+// Hash function object for unordered containers:
+//  std::unordered_set<Car, struct_hash>
+struct struct_hash {
+  template <typename T>
+  std::size_t operator()(T const& x) const { return hash_value(x); }
+};
+// end-sample
+
+#endif
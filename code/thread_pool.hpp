@@ -0,0 +1,264 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#ifndef CODE_THREAD_POOL_HPP
+#define CODE_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+// Work-stealing pool of threads running the jobs of fork/join computations.
+//
+// Each worker has its own queue of jobs. A worker runs the most recent job of
+// its own queue first and, when it is empty, steals the oldest job of another
+// queue. Jobs forked from a worker are pushed to that worker's queue, and jobs
+// forked from any other thread are spread over all the queues.
+//
+// A thread waiting for the jobs it forked runs jobs of the pool in the
+// meantime, so forking from within a job does not deadlock, and a pool with
+// a single worker still runs the jobs on two threads. Once there is nothing
+// left to run, it sleeps until the last of its jobs is done.
+
+namespace detail {
+  struct job {
+    void (*run)(void* context, std::size_t index);
+    void* context;
+    std::size_t index;
+  };
+
+  // State shared by the jobs of a fork and the thread joining them. The
+  // last job signals `done` while holding `mutex`, so the joining thread
+  // locks it once more before destroying the state.
+  struct fork_base {
+    std::atomic<std::size_t> remaining;
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr error;
+
+    explicit fork_base(std::size_t count) : remaining(count) { }
+    virtual ~fork_base() = default;
+  };
+
+  template <typename F>
+  struct fork : fork_base {
+    F f;
+
+    fork(std::size_t count, F f) : fork_base(count), f(std::move(f)) { }
+
+    static void run(void* context, std::size_t index) {
+      auto* self = static_cast<fork*>(context);
+      std::exception_ptr error;
+      try {
+        self->f(index);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      std::lock_guard<std::mutex> lock(self->mutex);
+      if (error && !self->error)
+        self->error = std::move(error);
+      if (self->remaining.fetch_sub(1, std::memory_order_release) == 1)
+        self->done.notify_all();
+    }
+  };
+}
+
+class thread_pool;
+
+// Handle to the jobs of a fork, which are joined by `join()` or by the
+// destructor. An empty handle has nothing to join.
+//
+// Like destroying a joinable `std::thread`, destroying or assigning to a
+// handle whose jobs threw an exception that was not rethrown by `join()`
+// calls `std::terminate()`, so that the exception is never silently lost.
+class join_handle {
+  thread_pool* pool_ = nullptr;
+  std::unique_ptr<detail::fork_base> fork_;
+
+public:
+  join_handle() = default;
+  join_handle(thread_pool* pool, std::unique_ptr<detail::fork_base> fork)
+    : pool_(pool), fork_(std::move(fork))
+  { }
+  join_handle(join_handle&&) = default;
+  join_handle& operator=(join_handle&& other) {
+    release();
+    pool_ = other.pool_;
+    fork_ = std::move(other.fork_);
+    return *this;
+  }
+  ~join_handle() { release(); }
+
+  bool joinable() const { return fork_ != nullptr; }
+
+  // Waits for all the jobs, and rethrows the first exception thrown by one
+  // of them, if any.
+  void join() {
+    wait();
+    if (fork_ && fork_->error) {
+      std::exception_ptr error = fork_->error;
+      fork_.reset();
+      std::rethrow_exception(error);
+    }
+    fork_.reset();
+  }
+
+private:
+  inline void wait();
+
+  void release() {
+    wait();
+    if (fork_ && fork_->error)
+      std::terminate();
+    fork_.reset();
+  }
+};
+
+class thread_pool {
+  struct queue {
+    std::mutex mutex;
+    std::deque<detail::job> jobs;
+  };
+
+  std::vector<std::unique_ptr<queue>> queues_;
+  std::vector<std::thread> workers_;
+  std::atomic<std::size_t> queued_{0};
+  std::atomic<std::size_t> next_{0};
+  std::mutex mutex_;
+  std::condition_variable wakeup_;
+  bool stopping_ = false;
+
+  struct worker_id { thread_pool const* pool; std::size_t index; };
+  static worker_id& current() {
+    static thread_local worker_id id{nullptr, 0};
+    return id;
+  }
+
+  bool pop(std::size_t index, detail::job& j) {
+    queue& q = *queues_[index];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.jobs.empty())
+      return false;
+    j = q.jobs.back();
+    q.jobs.pop_back();
+    return true;
+  }
+
+  bool steal(std::size_t index, detail::job& j) {
+    queue& q = *queues_[index];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.jobs.empty())
+      return false;
+    j = q.jobs.front();
+    q.jobs.pop_front();
+    return true;
+  }
+
+  void work(std::size_t index) {
+    current() = worker_id{this, index};
+    while (true) {
+      if (run_one())
+        continue;
+      std::unique_lock<std::mutex> lock(mutex_);
+      wakeup_.wait(lock, [&] { return stopping_ || queued_.load() != 0; });
+      if (stopping_ && queued_.load() == 0)
+        return;
+    }
+  }
+
+public:
+  explicit thread_pool(std::size_t threads = std::max(1u, std::thread::hardware_concurrency())) {
+    for (std::size_t i = 0; i != threads; ++i)
+      queues_.push_back(std::make_unique<queue>());
+    for (std::size_t i = 0; i != threads; ++i)
+      workers_.emplace_back([this, i] { work(i); });
+  }
+
+  thread_pool(thread_pool const&) = delete;
+  thread_pool& operator=(thread_pool const&) = delete;
+
+  // Runs the jobs still queued, and then stops the workers.
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    wakeup_.notify_all();
+    for (std::thread& worker : workers_)
+      worker.join();
+  }
+
+  std::size_t size() const { return workers_.size(); }
+
+  // Runs one queued job on the calling thread, if there is one.
+  bool run_one() {
+    worker_id self = current();
+    std::size_t n = queues_.size();
+    std::size_t first = self.pool == this ? self.index : 0;
+    detail::job j;
+    bool found = self.pool == this && pop(first, j);
+    for (std::size_t i = 0; !found && i != n; ++i)
+      found = steal((first + i) % n, j);
+    if (!found)
+      return false;
+    queued_.fetch_sub(1);
+    j.run(j.context, j.index);
+    return true;
+  }
+
+  // Calls `f(i)` for each `i` in `[0, count)` on the pool, and returns a
+  // handle to join these calls.
+  template <typename F>
+  join_handle fork(std::size_t count, F f) {
+    if (count == 0)
+      return join_handle{};
+    auto state = std::make_unique<detail::fork<F>>(count, std::move(f));
+    worker_id self = current();
+    queued_.fetch_add(count);
+    for (std::size_t i = 0; i != count; ++i) {
+      std::size_t index = self.pool == this ? self.index : next_++ % queues_.size();
+      queue& q = *queues_[index];
+      std::lock_guard<std::mutex> lock(q.mutex);
+      q.jobs.push_back(detail::job{&detail::fork<F>::run, state.get(), i});
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+    }
+    wakeup_.notify_all();
+    return join_handle{this, std::move(state)};
+  }
+
+  // Calls `f(i)` for each `i` in `[0, count)` on the pool, and returns once
+  // all of them returned.
+  template <typename F>
+  void parallel_for(std::size_t count, F f) {
+    fork(count, std::move(f)).join();
+  }
+};
+
+inline void join_handle::wait() {
+  if (!fork_)
+    return;
+  while (fork_->remaining.load(std::memory_order_acquire) != 0) {
+    if (pool_->run_one())
+      continue;
+
+    // Every job left is running on another thread.
+    std::unique_lock<std::mutex> lock(fork_->mutex);
+    fork_->done.wait(lock, [&] {
+      return fork_->remaining.load(std::memory_order_acquire) == 0;
+    });
+  }
+  std::lock_guard<std::mutex> lock(fork_->mutex);
+}
+
+#endif
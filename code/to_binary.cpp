@@ -0,0 +1,121 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#define BOOST_HANA_CONFIG_ENABLE_STRING_UDL
+#include "to_binary.hpp"
+
+#include <boost/hana.hpp>
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+namespace hana = boost::hana;
+using namespace hana::literals;
+
+
+struct Engine {
+  BOOST_HANA_DEFINE_STRUCT(Engine,
+    (int, cylinders),
+    (double, displacement)
+  );
+};
+
+struct Car {
+  BOOST_HANA_DEFINE_STRUCT(Car,
+    (std::string, brand),
+    (std::string, model),
+    (int, year),
+    (Engine, engine),
+    (std::vector<std::string>, options),
+    (std::vector<double>, prices)
+  );
+};
+
+bool operator==(Car const& a, Car const& b) {
+  return a.brand == b.brand && a.model == b.model && a.year == b.year &&
+         a.engine.cylinders == b.engine.cylinders &&
+         a.engine.displacement == b.engine.displacement &&
+         a.options == b.options && a.prices == b.prices;
+}
+
+int main() {
+  // sample(usage)
+  std::vector<Car> cars = {
+    {"BMW", "Z3", 1995, {6, 2.8}, {"roadster", "leather"}, {30000., 28000.}},
+    {"Audi", "A4", 2004, {4, 1.8}, {}, {25000.}},
+    {"Ferrari", "F40", 1987, {8, 2.9}, {"turbo"}, {400000., 1100000.}}
+  };
+
+  std::vector<unsigned char> bytes = to_binary(cars);
+  std::vector<Car> decoded = from_binary<std::vector<Car>>(bytes.data(), bytes.size());
+  // end-sample
+  assert(decoded == cars);
+
+  // Engines only have fixed-size members, so they are stored inline.
+  static_assert(detail::codec<Engine>::fixed, "");
+  static_assert(detail::codec<Engine>::inline_size == sizeof(int) + sizeof(double), "");
+  static_assert(!detail::codec<Car>::fixed, "");
+  assert(to_binary(cars[0].engine).size() == sizeof(int) + sizeof(double));
+
+  // Write the records to a file, and read them back without decoding them.
+  std::string path = "/tmp/cppnow-to-binary-" + std::to_string(::getpid());
+  {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    std::fwrite(bytes.data(), 1, bytes.size(), file);
+    std::fclose(file);
+  }
+
+  int fd = ::open(path.c_str(), O_RDONLY);
+  struct stat st;
+  ::fstat(fd, &st);
+  void* mapped = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  assert(mapped != MAP_FAILED);
+
+  // sample(view)
+  view<std::vector<Car>> snapshot{static_cast<unsigned char const*>(mapped),
+                                  static_cast<std::size_t>(st.st_size)};
+  view<Car> ferrari = snapshot[2];
+  std::string_view model = ferrari["model"_s]; // points into the file
+  int cylinders = ferrari["engine"_s]["cylinders"_s];
+  double last_price = ferrari["prices"_s][1];
+  // end-sample
+
+  assert(snapshot.size() == 3);
+  assert(model == "F40");
+  assert(cylinders == 8);
+  assert(last_price == 1100000.);
+  assert(snapshot[0]["options"_s].size() == 2);
+  assert(snapshot[0]["options"_s][1] == "leather");
+  assert(snapshot[1]["options"_s].size() == 0);
+  assert(snapshot[1]["year"_s] == 2004);
+  assert(ferrari.decode() == cars[2]);
+
+  ::munmap(mapped, st.st_size);
+
+  // Truncated or corrupted buffers are reported instead of being read past
+  // their end.
+  auto throws = [](auto f) {
+    try { f(); } catch (std::out_of_range const&) { return true; }
+    return false;
+  };
+  assert(throws([&] { view<std::vector<Car>>{bytes.data(), 3}; }));
+  assert(throws([&] { from_binary<std::vector<Car>>(bytes.data(), bytes.size() - 1); }));
+  assert(throws([&] { view<std::vector<Car>>(bytes.data(), bytes.size())[3]; }));
+
+  std::vector<unsigned char> corrupted = bytes;
+  std::uint32_t count = 1000000;
+  std::memcpy(corrupted.data(), &count, sizeof(count));
+  assert(throws([&] { view<std::vector<Car>>{corrupted.data(), corrupted.size()}; }));
+  std::remove(path.c_str());
+}
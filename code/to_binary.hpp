@@ -0,0 +1,411 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#ifndef CODE_TO_BINARY_HPP
+#define CODE_TO_BINARY_HPP
+
+#include <boost/hana.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+namespace hana = boost::hana;
+
+
+// Compact binary encoding of `hana::Struct`s, and views reading the members
+// of an encoded object straight out of a buffer (e.g. a `mmap`ed file)
+// without decoding it.
+//
+// The encoding of a Struct starts with a fixed section whose layout is
+// computed at compile-time from the members. Members of a fixed size
+// (arithmetic types, enums, and Structs made only of those) are stored inline
+// in that section. Every other member gets a slot there, made of the offset
+// and the size of its encoding in the variable section that follows:
+//
+//  | fixed section: inline members and slots | variable section |
+//
+// `std::string`s are encoded as their characters. `std::vector`s of fixed
+// size elements are encoded as their elements back to back; other vectors are
+// encoded as a count, one slot per element and the elements' encodings.
+// Offsets are relative to the start of the enclosing object, so any part of
+// an encoding is itself a valid encoding. Values are stored in the byte order
+// of the host, unaligned, and encodings must be smaller than 4GB.
+//
+// Views check every offset, size and count they read against the size of
+// their buffer, so a truncated or corrupted buffer throws `std::out_of_range`
+// instead of being read past its end.
+
+template <typename T>
+class view;
+
+namespace detail {
+  struct slot {
+    std::uint32_t offset;
+    std::uint32_t size;
+  };
+
+  // Throws unless `[offset, offset + size)` is within a buffer of
+  // `available` bytes.
+  inline void check_bounds(std::size_t offset, std::size_t size, std::size_t available) {
+    if (offset > available || size > available - offset)
+      throw std::out_of_range{"truncated or corrupted binary encoding"};
+  }
+
+  inline std::uint32_t narrow(std::size_t n) {
+    if (n > std::numeric_limits<std::uint32_t>::max())
+      throw std::length_error{"binary encodings must be smaller than 4GB"};
+    return static_cast<std::uint32_t>(n);
+  }
+
+  // Reads the slot at `in`, which must point into the fixed section of an
+  // object of `size` bytes, and checks that it points within that object.
+  inline slot read_slot(unsigned char const* in, std::size_t size) {
+    slot s;
+    std::memcpy(&s, in, sizeof(s));
+    check_bounds(s.offset, s.size, size);
+    return s;
+  }
+
+  inline void write_slot(unsigned char* out, std::size_t offset, std::size_t size) {
+    slot s{narrow(offset), narrow(size)};
+    std::memcpy(out, &s, sizeof(s));
+  }
+
+  // Each codec tells whether the encoding of its type has a fixed size, how
+  // many bytes the type takes in the fixed section of an enclosing Struct,
+  // and how to encode, decode and view it.
+  template <typename T, typename = void>
+  struct codec;
+
+  template <typename T>
+  struct codec<T, std::enable_if_t<std::is_arithmetic<T>::value || std::is_enum<T>::value>> {
+    static constexpr bool fixed = true;
+    static constexpr std::size_t inline_size = sizeof(T);
+    using view_type = T;
+
+    static std::size_t size(T const&) { return sizeof(T); }
+    static unsigned char* write(unsigned char* out, T const& x) {
+      std::memcpy(out, &x, sizeof(T));
+      return out + sizeof(T);
+    }
+    static T read(unsigned char const* in, std::size_t size) {
+      check_bounds(0, sizeof(T), size);
+      T x;
+      std::memcpy(&x, in, sizeof(T));
+      return x;
+    }
+    static T view(unsigned char const* in, std::size_t size) { return read(in, size); }
+  };
+
+  template <>
+  struct codec<std::string> {
+    static constexpr bool fixed = false;
+    static constexpr std::size_t inline_size = sizeof(slot);
+    using view_type = std::string_view;
+
+    static std::size_t size(std::string const& s) { return s.size(); }
+    static unsigned char* write(unsigned char* out, std::string const& s) {
+      std::memcpy(out, s.data(), s.size());
+      return out + s.size();
+    }
+    static std::string read(unsigned char const* in, std::size_t size) {
+      return std::string(reinterpret_cast<char const*>(in), size);
+    }
+    static std::string_view view(unsigned char const* in, std::size_t size) {
+      return std::string_view(reinterpret_cast<char const*>(in), size);
+    }
+  };
+
+  template <typename U, typename Allocator>
+  struct codec<std::vector<U, Allocator>> {
+    using Element = codec<U>;
+    static constexpr bool fixed = false;
+    static constexpr std::size_t inline_size = sizeof(slot);
+    using view_type = ::view<std::vector<U, Allocator>>;
+
+    static std::size_t size(std::vector<U, Allocator> const& xs) {
+      if constexpr (Element::fixed) {
+        return xs.size() * Element::inline_size;
+      } else {
+        std::size_t size = sizeof(std::uint32_t) + xs.size() * sizeof(slot);
+        for (auto const& x : xs)
+          size += Element::size(x);
+        return size;
+      }
+    }
+
+    static unsigned char* write(unsigned char* out, std::vector<U, Allocator> const& xs) {
+      if constexpr (Element::fixed) {
+        for (auto const& x : xs)
+          out = Element::write(out, x);
+        return out;
+      } else {
+        std::uint32_t count = narrow(xs.size());
+        std::memcpy(out, &count, sizeof(count));
+        unsigned char* slots = out + sizeof(count);
+        unsigned char* next = slots + xs.size() * sizeof(slot);
+        for (auto const& x : xs) {
+          unsigned char* end = Element::write(next, x);
+          write_slot(slots, next - out, end - next);
+          slots += sizeof(slot);
+          next = end;
+        }
+        return next;
+      }
+    }
+
+    static std::vector<U, Allocator> read(unsigned char const* in, std::size_t size) {
+      auto v = view(in, size);
+      std::vector<U, Allocator> xs;
+      xs.reserve(v.size());
+      for (std::size_t i = 0; i != v.size(); ++i)
+        xs.push_back(v.element(i).decode());
+      return xs;
+    }
+
+    static view_type view(unsigned char const* in, std::size_t size) { return {in, size}; }
+  };
+
+  template <std::size_t ...sizes>
+  constexpr std::array<std::size_t, sizeof...(sizes) + 1> prefix_sums() {
+    std::size_t in[] = {sizes..., 0};
+    std::array<std::size_t, sizeof...(sizes) + 1> out{};
+    for (std::size_t k = 0; k != sizeof...(sizes); ++k)
+      out[k + 1] = out[k] + in[k];
+    return out;
+  }
+
+  template <typename T, typename Indices = std::make_index_sequence<
+    decltype(hana::length(hana::accessors<T>()))::value
+  >>
+  struct layout;
+
+  template <typename T, std::size_t ...i>
+  struct layout<T, std::index_sequence<i...>> {
+    using Members = decltype(hana::accessors<T>());
+
+    template <std::size_t k>
+    using member = std::decay_t<decltype(hana::at_c<k>(std::declval<Members>()))>;
+
+    template <std::size_t k>
+    using name = std::decay_t<decltype(hana::first(std::declval<member<k>>()))>;
+
+    template <std::size_t k>
+    using type = std::decay_t<decltype(hana::second(std::declval<member<k>>())(std::declval<T&>()))>;
+
+    static constexpr bool fixed = (true && ... && codec<type<i>>::fixed);
+
+    // offsets[k] is the offset of the k-th member in the fixed section, and
+    // offsets[sizeof...(i)] is the size of the fixed section.
+    static constexpr std::array<std::size_t, sizeof...(i) + 1> offsets =
+      prefix_sums<codec<type<i>>::inline_size...>();
+    static constexpr std::size_t fixed_size = offsets[sizeof...(i)];
+
+    template <typename Name>
+    static constexpr std::size_t index_of(Name) {
+      constexpr bool matches[] = {std::is_same<Name, name<i>>::value..., false};
+      std::size_t k = 0;
+      while (k != sizeof...(i) && !matches[k]) ++k;
+      return k;
+    }
+
+    template <std::size_t k>
+    static decltype(auto) get(T const& x) {
+      return hana::second(hana::at_c<k>(hana::accessors<T>()))(x);
+    }
+
+    // Location and size of the encoding of the k-th member of the object
+    // encoded in the `size` bytes at `in`, which hold at least the fixed
+    // section.
+    template <std::size_t k>
+    static std::pair<unsigned char const*, std::size_t> locate(unsigned char const* in, std::size_t size) {
+      if constexpr (codec<type<k>>::fixed) {
+        return {in + offsets[k], codec<type<k>>::inline_size};
+      } else {
+        slot s = read_slot(in + offsets[k], size);
+        return {in + s.offset, s.size};
+      }
+    }
+  };
+
+  template <typename T>
+  struct codec<T, std::enable_if_t<hana::Struct<T>::value>> {
+    using Layout = layout<T>;
+    static constexpr bool fixed = Layout::fixed;
+    static constexpr std::size_t inline_size = fixed ? Layout::fixed_size : sizeof(slot);
+    using view_type = ::view<T>;
+
+    static std::size_t size(T const& x) {
+      return size(x, std::make_index_sequence<Layout::offsets.size() - 1>{});
+    }
+
+    static unsigned char* write(unsigned char* out, T const& x) {
+      return write(out, x, std::make_index_sequence<Layout::offsets.size() - 1>{});
+    }
+
+    static T read(unsigned char const* in, std::size_t size) { return view(in, size).decode(); }
+    static view_type view(unsigned char const* in, std::size_t size) { return {in, size}; }
+
+  private:
+    template <std::size_t ...i>
+    static std::size_t size(T const& x, std::index_sequence<i...>) {
+      std::size_t size = Layout::fixed_size;
+      ((size += codec<typename Layout::template type<i>>::fixed
+          ? 0 : codec<typename Layout::template type<i>>::size(Layout::template get<i>(x))), ...);
+      return size;
+    }
+
+    template <std::size_t ...i>
+    static unsigned char* write(unsigned char* out, T const& x, std::index_sequence<i...>) {
+      unsigned char* next = out + Layout::fixed_size;
+      auto write_member = [&](auto k) {
+        using Codec = codec<typename Layout::template type<decltype(k)::value>>;
+        auto const& member = Layout::template get<decltype(k)::value>(x);
+        if constexpr (Codec::fixed) {
+          Codec::write(out + Layout::offsets[decltype(k)::value], member);
+        } else {
+          unsigned char* end = Codec::write(next, member);
+          write_slot(out + Layout::offsets[decltype(k)::value], next - out, end - next);
+          next = end;
+        }
+      };
+      (write_member(std::integral_constant<std::size_t, i>{}), ...);
+      return next;
+    }
+  };
+}
+
+// sample(view)
+// Read-only view of a Struct encoded by `to_binary`. `v["price"_s]` reads the
+// `price` member without decoding anything else: strings are viewed as
+// `std::string_view`s and nested Structs and vectors as `view`s into the same
+// buffer. The buffer must outlive the view.
+template <typename T>
+class view {
+  using Layout = detail::layout<T>;
+  unsigned char const* data_;
+  std::size_t size_;
+
+public:
+  view(unsigned char const* data, std::size_t size) : data_(data), size_(size) {
+    detail::check_bounds(0, Layout::fixed_size, size_);
+  }
+
+  template <typename Name>
+  auto operator[](Name name) const {
+    constexpr std::size_t k = Layout::index_of(Name{});
+    static_assert(k != Layout::offsets.size() - 1,
+      "trying to access an unknown member");
+    using Codec = detail::codec<typename Layout::template type<k>>;
+    auto where = Layout::template locate<k>(data_, size_);
+    return Codec::view(where.first, where.second);
+  }
+
+  T decode() const {
+    T x;
+    hana::for_each(hana::accessors<T>(), [&](auto member) {
+      using Member = std::decay_t<decltype(hana::second(member)(x))>;
+      constexpr std::size_t k = Layout::index_of(std::decay_t<decltype(hana::first(member))>{});
+      auto where = Layout::template locate<k>(data_, size_);
+      hana::second(member)(x) = detail::codec<Member>::read(where.first, where.second);
+    });
+    return x;
+  }
+
+  unsigned char const* data() const { return data_; }
+  std::size_t size() const { return size_; }
+};
+// end-sample
+
+template <typename U, typename Allocator>
+class view<std::vector<U, Allocator>> {
+  using Element = detail::codec<U>;
+  unsigned char const* data_;
+  std::size_t size_;
+  std::size_t count_;
+
+  // Location and size of the encoding of the i-th element.
+  std::pair<unsigned char const*, std::size_t> locate(std::size_t i) const {
+    if (i >= count_)
+      throw std::out_of_range{"trying to access an element past the end of a vector view"};
+    if constexpr (Element::fixed) {
+      return {data_ + i * Element::inline_size, Element::inline_size};
+    } else {
+      detail::slot s = detail::read_slot(data_ + sizeof(std::uint32_t) + i * sizeof(detail::slot), size_);
+      return {data_ + s.offset, s.size};
+    }
+  }
+
+public:
+  // The count and the slot table of the elements must be within the buffer.
+  view(unsigned char const* data, std::size_t size) : data_(data), size_(size) {
+    if constexpr (Element::fixed) {
+      count_ = size_ / Element::inline_size;
+    } else {
+      std::uint32_t count;
+      detail::check_bounds(0, sizeof(count), size_);
+      std::memcpy(&count, data_, sizeof(count));
+      if (count > (size_ - sizeof(count)) / sizeof(detail::slot))
+        throw std::out_of_range{"truncated or corrupted binary encoding"};
+      count_ = count;
+    }
+  }
+
+  std::size_t size() const { return count_; }
+
+  auto operator[](std::size_t i) const {
+    auto where = locate(i);
+    return Element::view(where.first, where.second);
+  }
+
+  // A view of the i-th element that can be decoded with `decode()`.
+  auto element(std::size_t i) const {
+    struct decodable {
+      unsigned char const* data;
+      std::size_t size;
+      U decode() const { return Element::read(data, size); }
+    };
+    auto where = locate(i);
+    return decodable{where.first, where.second};
+  }
+
+  std::vector<U, Allocator> decode() const { return Element::read(data_, size_); }
+};
+
+// sample(to_binary)
+template <typename T>
+std::size_t binary_size(T const& x) {
+  return detail::codec<T>::size(x);
+}
+
+// Encodes `x` into `out`, replacing its contents. Reusing the same buffer
+// across calls avoids allocating.
+template <typename T>
+void to_binary(T const& x, std::vector<unsigned char>& out) {
+  out.resize(binary_size(x));
+  unsigned char* end = detail::codec<T>::write(out.data(), x);
+  (void)end;
+}
+
+template <typename T>
+std::vector<unsigned char> to_binary(T const& x) {
+  std::vector<unsigned char> out;
+  to_binary(x, out);
+  return out;
+}
+
+template <typename T>
+T from_binary(unsigned char const* data, std::size_t size) {
+  return detail::codec<T>::read(data, size);
+}
+// end-sample
+
+#endif
@@ -0,0 +1,86 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+
+#ifndef CODE_TO_JSON_HPP
+#define CODE_TO_JSON_HPP
+
+#include <boost/hana.hpp>
+
+#include <functional>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+namespace hana = boost::hana;
+
+
+// 1. Define some utilities
+template <typename Xs>
+std::string join(Xs&& xs, std::string sep) {
+  return hana::fold(hana::intersperse(std::forward<Xs>(xs), sep), "", std::plus<>{});
+}
+
+inline std::string quote(std::string s) { return "\"" + s + "\""; }
+
+template <typename T>
+auto to_json(T const& x) -> decltype(std::to_string(x)) {
+  return std::to_string(x);
+}
+
+inline std::string to_json(char c) { return quote({c}); }
+inline std::string to_json(std::string s) { return quote(s); }
+
+// Declare the overloads below up front, so each of them can print members and
+// elements handled by the others.
+template <typename T>
+  std::enable_if_t<hana::Struct<T>::value,
+std::string> to_json(T const& x);
+
+template <typename Xs>
+  std::enable_if_t<hana::Sequence<Xs>::value,
+std::string> to_json(Xs const& xs);
+
+template <typename Xs, typename = decltype(std::begin(std::declval<Xs const&>()))>
+  std::enable_if_t<!hana::Sequence<Xs>::value && !std::is_convertible<Xs, std::string>::value,
+std::string> to_json(Xs const& xs);
+
+
+// 2. Define how to print user-defined types
+template <typename T>
+  std::enable_if_t<hana::Struct<T>::value,
+std::string> to_json(T const& x) {
+  auto json = hana::transform(hana::keys(x), [&](auto name) {
+    auto const& member = hana::at_key(x, name);
+    return quote(hana::to<char const*>(name)) + " : " + to_json(member);
+  });
+
+  return "{" + join(std::move(json), ", ") + "}";
+}
+
+// 3. Define how to print Sequences
+template <typename Xs>
+  std::enable_if_t<hana::Sequence<Xs>::value,
+std::string> to_json(Xs const& xs) {
+  auto json = hana::transform(xs, [](auto const& x) {
+    return to_json(x);
+  });
+
+  return "[" + join(std::move(json), ", ") + "]";
+}
+
+// 4. Define how to print runtime ranges, like std::vector
+template <typename Xs, typename>
+  std::enable_if_t<!hana::Sequence<Xs>::value && !std::is_convertible<Xs, std::string>::value,
+std::string> to_json(Xs const& xs) {
+  std::string json = "[";
+  bool first = true;
+  for (auto&& x : xs) {
+    if (!first)
+      json += ", ";
+    json += to_json(x);
+    first = false;
+  }
+  return json + "]";
+}
+
+#endif
@@ -212,7 +212,7 @@ function(metabench_add_dataset target path_to_template range)
 endfunction()
 
 # metabench_add_chart(target [ALL]
-#                     [ASPECT COMPILATION_TIME|LINK_TIME|EXECUTION_TIME|EXECUTABLE_SIZE]
+#                     [ASPECT COMPILATION_TIME|LINK_TIME|EXECUTION_TIME|EXECUTABLE_SIZE|<counter>]
 #                     [TITLE title]
 #                     [SUBTITLE subtitle]
 #                     [XLABEL label] [YLABEL label]
@@ -236,7 +236,7 @@ endfunction()
 #       This is the same behaviour as `add_custom_target` used with the `ALL`
 #       keyword.
 #
-#   [ASPECT COMPILATION_TIME|LINK_TIME|EXECUTION_TIME|EXECUTABLE_SIZE]:
+#   [ASPECT COMPILATION_TIME|LINK_TIME|EXECUTION_TIME|EXECUTABLE_SIZE|<counter>]:
 #       The aspect of the datasets to display on the chart. When this argument
 #       is provided, the chart will adopt reasonable default values for the
 #       axis labels and other similar settings. However, any setting set
@@ -244,6 +244,20 @@ endfunction()
 #       over anything defaulted by the choice of an `ASPECT`. When no aspect
 #       is provided, it defaults to `COMPILATION_TIME`.
 #
+#       Any other aspect names a counter reported by the executable through
+#       `metabench::perf_region` (see `benchmark/perf.hpp`), which measures
+#       a single region of the program with the hardware performance counters.
+#       The available counters are `REGION_TIME`, `THROUGHPUT`,
+#       `CYCLES_PER_ITERATION`, `CYCLES`, `INSTRUCTIONS`, `BRANCH_MISSES`,
+#       `L1D_MISSES` and `LLC_MISSES`, along with `ALLOCATIONS` and
+#       `BYTES_ALLOCATED`, which count the calls to `operator new` made in
+#       the region when the executable is linked with
+#       `benchmark/allocations.cpp`. Benchmarks using the helpers of
+#       `benchmark/workload.hpp` also report `LATENCY_P50`, `LATENCY_P99`
+#       and `LATENCY_P999`, in nanoseconds. A benchmark may also print its
+#       own `[perf <counter>: <value>]` lines, like `BYTES_PER_OBJECT`,
+#       `ENCODED_BYTES` or `EMITTED_BYTES`.
+#
 #   [TITLE title]:
 #       A title to use for the generated chart. If this is not provided, the
 #       chart has no title.
@@ -396,6 +410,11 @@ file(WRITE ${METABENCH_RB_PATH}
 "    report_error(exe_file, stdout, stderr, IO.read(cpp_file))                                            \n"
 "  end                                                                                                    \n"
 "                                                                                                         \n"
+"  # Hardware counters and timings of a region of the executable, reported by                             \n"
+"  # `metabench::perf_region` (see `benchmark/perf.hpp`) on its stdout.                                   \n"
+"  result['counters'] = {}                                                                                \n"
+"  stdout.scan(/\\[perf (\\w+): (.+)\\]/) { |name, value| result['counters'][name] = value.to_f }         \n"
+"                                                                                                         \n"
 "  return result                                                                                          \n"
 "end                                                                                                      \n"
 "                                                                                                         \n"
@@ -426,6 +445,9 @@ file(WRITE ${METABENCH_RB_PATH}
 "      datum['link_times']        = results.map { |r| (scale)*r['link_time'] }                            \n"
 "      datum['executable_size']   = results.map { |r| (scale)*r['executable_size'] }.first                \n"
 "      datum['execution_times']   = results.map { |r| (scale)*r['execution_time'] }                       \n"
+"      datum['counters']          = results.flat_map { |r| r['counters'].keys }.uniq.map { |name|         \n"
+"        [name, results.map { |r| r['counters'][name] }.compact]                                          \n"
+"      }.to_h                                                                                             \n"
 "      return datum                                                                                       \n"
 "    }                                                                                                    \n"
 "    code = render(erb_template, n, env)                                                                  \n"
@@ -551,7 +573,8 @@ file(WRITE ${CHART_HTML_ERB_PATH}
 "      //           compilation_times: [<compilation times in seconds>],                                                    \n"
 "      //           link_times:        [<link times in seconds>],                                                           \n"
 "      //           executable_size:   <executable size in KB>,                                                             \n"
-"      //           execution_times:   [<execution times in seconds>]                                                       \n"
+"      //           execution_times:   [<execution times in seconds>],                                                      \n"
+"      //           counters:          {<counter name>: [<values reported by perf_region>]}                                 \n"
 "      //       },                                                                                                          \n"
 "      //       total: <same as base, but with METABENCH defined>                                                           \n"
 "      //   }]                                                                                                              \n"
@@ -607,6 +630,30 @@ file(WRITE ${CHART_HTML_ERB_PATH}
 "               tickFormat: function(val){ return d3.format('.2f')(val) + 's'; }                                            \n"
 "             });                                                                                                           \n"
 "      }                                                                                                                    \n"
+"      else {                                                                                                               \n"
+"        // Any other aspect is a counter reported by `perf_region`, e.g. CYCLES_PER_ITERATION                              \n"
+"        // or BRANCH_MISSES; datasets that did not report it are drawn at zero.                                            \n"
+"        var counter = aspect.toLowerCase();                                                                                \n"
+"        var labels = {                                                                                                     \n"
+"          region_time: 'Region time', throughput: 'Iterations per second',                                                 \n"
+"          cycles_per_iteration: 'Cycles per iteration',                                                                    \n"
+"          cycles: 'Cycles', instructions: 'Instructions', branch_misses: 'Branch misses',                                  \n"
+"          l1d_misses: 'L1D misses', llc_misses: 'LLC misses',                                                              \n"
+"          latency_p50: 'p50 latency', latency_p99: 'p99 latency', latency_p999: 'p99.9 latency',                           \n"
+"          allocations: 'Allocations', bytes_allocated: 'Bytes allocated',                                                  \n"
+"          bytes_per_object: 'Bytes per object', encoded_bytes: 'Encoded bytes', emitted_bytes: 'Emitted bytes'             \n"
+"        };                                                                                                                 \n"
+"        chart.y(function(datum){                                                                                           \n"
+"               var values = (datum.total.counters || {})[counter];                                                         \n"
+"               return values && values.length ? median(values) : 0;                                                        \n"
+"             })                                                                                                            \n"
+"             .yAxis.options({                                                                                              \n"
+"               axisLabel: customSettings.YLABEL || labels[counter] || counter,                                             \n"
+"               tickFormat: counter == 'region_time' ? function(val){ return d3.format('.2f')(val) + 's'; }                 \n"
+"                         : counter.indexOf('latency_') == 0 ? function(val){ return d3.format('.0f')(val) + 'ns'; }        \n"
+"                         : d3.format('.3s')                                                                                \n"
+"             });                                                                                                           \n"
+"      }                                                                                                                    \n"
 "                                                                                                                           \n"
 "      chart.interpolate('basis').useInteractiveGuideline(true);                                                            \n"
 "      d3.select('#chart').datum(data).call(chart);                                                                         \n"